@@ -1,7 +1,9 @@
 module;
 // Use #include directives between here and the
 // export module as you would normally.
+#include <cstdint>
 #include <string>
+#include <vector>
 
 // Mandatory
 export module opn.UserApp;
@@ -26,16 +28,17 @@ protected:
             opn::Locator::submit(opn::eJobType::General, [ecs]() {
                 opn::logInfo("App", "Starting mass entity spawn...");
 
-                for (int i = 0; i < 1000; ++i) {
-                    const auto e = ecs->createEntity();
-                    ecs->addComponent(e, opn::components::Transform{
-                        .position = { static_cast<float>(i), 0.0f, 0.0f },
-                        .rotation = {},
-                        .scale    = {}
-                    });
+                constexpr uint32_t count = 1000;
+                std::vector<opn::tEntity> entities(count);
+                std::vector<opn::components::Transform> transforms(count);
+
+                ecs->createEntities(count, entities);
+                for (uint32_t i = 0; i < count; ++i) {
+                    transforms[i].position = { static_cast<float>(i), 0.0f, 0.0f };
                 }
+                ecs->addComponents<opn::components::Transform>(entities, transforms);
 
-                opn::logInfo("App", "Successfully queued 1000 entities!");
+                opn::logInfo("App", "Successfully queued {} entities!", count);
             });
         }
     }
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import opn.ECS;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Position {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+    };
+
+    struct Velocity {
+        float x = 1.0f, y = 0.0f, z = 0.0f;
+    };
+
+    struct sResult {
+        std::string_view name;
+        size_t entities = 0;
+        double bestMs = 0.0;
+    };
+
+    /**
+     * @brief Best of _runs; _setup runs before each timed _fn and is not measured.
+     */
+    template<typename Setup, typename Fn>
+    double bestOfMs(const int _runs, Setup &&_setup, Fn &&_fn) {
+        double best = 1e30;
+        for (int run = 0; run < _runs; ++run) {
+            _setup();
+            const auto start = Clock::now();
+            _fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // Keeps the optimiser from discarding read-only loops.
+    volatile float g_sink = 0.0f;
+}
+
+struct ECSBench {
+    std::vector<sResult> results;
+
+    static std::vector<opn::tEntity> spawn(opn::World &_world, const size_t _count) {
+        std::vector<opn::tEntity> entities(_count);
+        _world.createEntities(std::span(entities));
+        return entities;
+    }
+
+    /**
+     * @brief Every entity gets a Position, every other one a Velocity.
+     */
+    static std::vector<opn::tEntity> populate(opn::World &_world, const size_t _count) {
+        auto entities = spawn(_world, _count);
+        for (size_t i = 0; i < entities.size(); ++i) {
+            _world.addComponent(entities[i], Position{static_cast<float>(i), 0.0f, 0.0f});
+            if (i % 2 == 0) _world.addComponent(entities[i], Velocity{});
+        }
+        return entities;
+    }
+
+    void record(const std::string_view _name, const size_t _count, const double _ms) {
+        results.push_back({_name, _count, _ms});
+        std::println("{:>9} entities | {:<22} {:9.3f} ms | {:8.2f} ns/entity", _count, _name, _ms,
+                     _ms * 1e6 / static_cast<double>(_count));
+    }
+
+    void run(const size_t _count) {
+        const int runs = _count >= 1'000'000 ? 3 : 5;
+        std::unique_ptr<opn::World> world;
+        std::vector<opn::tEntity> entities;
+
+        const auto fresh = [&] { world = std::make_unique<opn::World>(); };
+        const auto populated = [&] {
+            fresh();
+            entities = populate(*world, _count);
+        };
+
+        record("create", _count, bestOfMs(runs, fresh, [&] { entities = spawn(*world, _count); }));
+
+        record("destroy", _count, bestOfMs(runs, [&] {
+            fresh();
+            entities = spawn(*world, _count);
+        }, [&] {
+            for (const auto entity: entities) world->destroyEntity(entity);
+        }));
+
+        record("add_component", _count, bestOfMs(runs, [&] {
+            fresh();
+            entities = spawn(*world, _count);
+        }, [&] {
+            for (const auto entity: entities) world->addComponent(entity, Position{});
+        }));
+
+        record("remove_component", _count, bestOfMs(runs, populated, [&] {
+            for (const auto entity: entities) world->removeComponent<Position>(entity);
+        }));
+
+        populated();
+        record("iterate_single", _count, bestOfMs(runs, [] {}, [&] {
+            float sum = 0.0f;
+            world->forEach<Position>([&](opn::tEntity, const Position &_position) { sum += _position.x; });
+            g_sink = sum;
+        }));
+
+        record("iterate_pair", _count, bestOfMs(runs, [] {}, [&] {
+            world->forEach<Position, Velocity>([](opn::tEntity, Position &_position, const Velocity &_velocity) {
+                _position.x += _velocity.x;
+                _position.y += _velocity.y;
+                _position.z += _velocity.z;
+            });
+        }));
+
+        std::vector<opn::tEntity> shuffled = entities;
+        std::ranges::shuffle(shuffled, std::mt19937(1234));
+        const opn::World &view = *world;
+        record("random_get_component", _count, bestOfMs(runs, [] {}, [&] {
+            float sum = 0.0f;
+            for (const auto entity: shuffled) {
+                if (const auto *position = view.getComponent<Position>(entity)) sum += position->x;
+            }
+            g_sink = sum;
+        }));
+
+        opn::EntityCommandBuffer ecb;
+        opn::tEntity entity;
+        // Recording leaves commands behind, flush them into the old world before replacing it.
+        record("ecb_record", _count, bestOfMs(runs, [&] {
+            world->playback(ecb);
+            fresh();
+        }, [&] {
+            for (size_t i = 0; i < _count; ++i) {
+                world->reserveEntities(std::span(&entity, 1));
+                ecb.create(entity);
+                ecb.addComponent(entity, Position{static_cast<float>(i), 0.0f, 0.0f});
+            }
+        }));
+        world->playback(ecb);
+
+        record("ecb_playback", _count, bestOfMs(runs, [&] {
+            fresh();
+            for (size_t i = 0; i < _count; ++i) {
+                world->reserveEntities(std::span(&entity, 1));
+                ecb.create(entity);
+                ecb.addComponent(entity, Position{static_cast<float>(i), 0.0f, 0.0f});
+            }
+        }, [&] {
+            world->playback(ecb);
+        }));
+    }
+
+    void writeJson(const std::string &_path) const {
+        std::ofstream file(_path, std::ios::trunc);
+        std::println(file, "{{");
+        std::println(file, "  \"benchmark\": \"ECSBench\",");
+        std::println(file, "  \"results\": [");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto &[name, entities, bestMs] = results[i];
+            std::println(file, "    {{\"name\": \"{}\", \"entities\": {}, \"best_ms\": {:.6f}, \"ns_per_entity\": {:.4f}}}{}",
+                         name, entities, bestMs, bestMs * 1e6 / static_cast<double>(entities),
+                         i + 1 < results.size() ? "," : "");
+        }
+        std::println(file, "  ]");
+        std::println(file, "}}");
+
+        if (!file) std::println(stderr, "Failed to write {}", _path);
+        else std::println("Results written to {}", _path);
+    }
+};
+
+/**
+ * @brief Usage: ECSBench [output.json], defaults to ECSBench.json in the working directory.
+ */
+int main(const int _argc, char **_argv) {
+    ECSBench bench;
+    for (const size_t count: {1'000uz, 100'000uz, 1'000'000uz}) {
+        bench.run(count);
+    }
+
+    bench.writeJson(_argc > 1 ? _argv[1] : "ECSBench.json");
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "hlsl++.h"
+
+import opn.ECS;
+import opn.ECS.Components;
+
+namespace {
+    using namespace opn;
+    using Clock = std::chrono::steady_clock;
+
+    template<typename Fn>
+    double bestOfMs(const int _runs, Fn &&_fn) {
+        double best = 1e30;
+        for (int run = 0; run < _runs; ++run) {
+            const auto start = Clock::now();
+            _fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+
+    /**
+     * @brief Every entity gets a Transform, a random half also a Renderable, inserted in shuffled
+     * order so the two dense arrays do not line up by accident.
+     */
+    void populate(World &_world, const size_t _count) {
+        std::vector<tEntity> entities(_count);
+        _world.createEntities(std::span(entities));
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        for (const auto entity: entities) {
+            _world.addComponent(entity, components::Transform{
+                                    .position = hlslpp::float3(position(rng), position(rng), position(rng))
+                                });
+        }
+
+        std::ranges::shuffle(entities, rng);
+        for (size_t i = 0; i < _count / 2; ++i) {
+            _world.addComponent(entities[i], components::Renderable{});
+        }
+    }
+
+    // Touches both components so neither load can be skipped; the checksum ignores visit order.
+    uint64_t walk(World &_world) {
+        uint64_t sum = 0;
+        _world.forEach<components::Transform, components::Renderable>(
+            [&](const tEntity _entity, const components::Transform &_transform,
+                const components::Renderable &_renderable) {
+                if (_renderable.visible && hlslpp::any(_transform.scale != hlslpp::float3(0.0f))) sum += _entity.index();
+            });
+        return sum;
+    }
+
+    /**
+     * @brief Removes and re-adds 1% of the Renderables, the bookkeeping a group adds per edit.
+     */
+    void churn(World &_world) {
+        const auto entities = _world.entitiesWith<components::Renderable>();
+        const std::vector<tEntity> picked(entities.begin(), entities.begin() + entities.size() / 100);
+        for (const auto entity: picked) _world.removeComponent<components::Renderable>(entity);
+        for (const auto entity: picked) _world.addComponent(entity, components::Renderable{});
+    }
+
+    void run(const size_t _count) {
+        World plain;
+        World grouped;
+        populate(plain, _count);
+        populate(grouped, _count);
+        grouped.group<components::Transform, components::Renderable>();
+
+        uint64_t plainSum = 0, groupedSum = 0;
+        const double plainMs = bestOfMs(10, [&] { plainSum = walk(plain); });
+        const double groupedMs = bestOfMs(10, [&] { groupedSum = walk(grouped); });
+        const double plainChurnMs = bestOfMs(5, [&] { churn(plain); });
+        const double groupedChurnMs = bestOfMs(5, [&] { churn(grouped); });
+
+        std::println("{:>9} entities | sparse lookup {:8.3f} ms | group {:8.3f} ms | speedup {:5.2f}x | "
+                     "1% churn {:7.3f} ms -> {:7.3f} ms | checksum {}",
+                     _count, plainMs, groupedMs, plainMs / groupedMs, plainChurnMs, groupedChurnMs,
+                     plainSum == groupedSum ? "match" : "MISMATCH");
+    }
+}
+
+int main() {
+    for (const size_t count: {10'000uz, 100'000uz, 1'000'000uz}) {
+        run(count);
+    }
+    return 0;
+}
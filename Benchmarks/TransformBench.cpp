@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <print>
+#include <random>
+#include <vector>
+
+#include "hlsl++.h"
+
+import opn.ECS.Components;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<opn::components::Transform> makeTransforms(const size_t _count) {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+        std::vector<opn::components::Transform> transforms(_count);
+        for (auto &transform: transforms) {
+            transform.position = hlslpp::float3(position(rng), position(rng), position(rng));
+            transform.rotation = hlslpp::normalize(hlslpp::quaternion(unit(rng), unit(rng), unit(rng), unit(rng)));
+            transform.scale = hlslpp::float3(scale(rng), scale(rng), scale(rng));
+        }
+        return transforms;
+    }
+
+    template<typename Fn>
+    double bestOfMs(const int _runs, Fn &&_fn) {
+        double best = 1e30;
+        for (int run = 0; run < _runs; ++run) {
+            const auto start = Clock::now();
+            _fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+
+    void run(const size_t _count) {
+        const auto transforms = makeTransforms(_count);
+        std::vector<hlslpp::float4x4> reference(_count);
+        std::vector<hlslpp::float4x4> batched(_count);
+        opn::components::TransformSoA soa;
+
+        const double aosMs = bestOfMs(5, [&] {
+            for (size_t i = 0; i < _count; ++i) {
+                reference[i] = transforms[i].getMatrix();
+            }
+        });
+
+        const double gatherMs = bestOfMs(5, [&] { soa.assign(transforms); });
+        const double kernelMs = bestOfMs(5, [&] { opn::components::buildWorldMatrices(soa, batched); });
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < _count; ++i) {
+            float lhs[16], rhs[16];
+            hlslpp::store(lhs, reference[i]);
+            hlslpp::store(rhs, batched[i]);
+            for (int j = 0; j < 16; ++j) {
+                maxError = std::max(maxError, std::abs(lhs[j] - rhs[j]));
+            }
+        }
+
+        std::println("{:>9} entities | getMatrix {:8.3f} ms | gather {:8.3f} ms | kernel {:8.3f} ms | "
+                     "speedup {:5.2f}x (kernel) {:5.2f}x (gather+kernel) | max error {:.2e}",
+                     _count, aosMs, gatherMs, kernelMs, aosMs / kernelMs, aosMs / (gatherMs + kernelMs), maxError);
+    }
+}
+
+int main() {
+    for (const size_t count: {10'000uz, 100'000uz, 1'000'000uz}) {
+        run(count);
+    }
+    return 0;
+}
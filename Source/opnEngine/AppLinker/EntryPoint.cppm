@@ -1,8 +1,10 @@
 module;
 
 #include <chrono>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <thread>
 
 // all my homies hate the Windows terminal
@@ -17,11 +19,14 @@ module;
 export module opn.Engine;
 import opn.Utils.Locator;
 import opn.System.Jobs.Dispatcher;
+import opn.System.ServiceInterface;
+import opn.System.Profiling;
 import opn.Application;
 import opn.Modules.Services;
 import opn.Modules.ServiceList;
 import opn.System.Service.Time;
 import opn.System.Service.WindowSystem;
+import opn.System.Service.Rendering;
 import opn.Utils.Logging;
 
 export namespace opn::detail {
@@ -43,6 +48,21 @@ export namespace opn::detail {
 #endif
 
     int runEngine() {
+        // e.g. OPN_LOG_FILTER="*=Info, VulkanBackend=Trace" for a production run.
+        if (const char* filters = std::getenv("OPN_LOG_FILTER"); filters && !Logger::configureFilters(filters)) {
+            opn::logWarning("OPN Engine", "Ignored malformed entries in OPN_LOG_FILTER: {}", filters);
+        }
+        // OPN_LOG_FILE and OPN_LOG_JSON add a rotated text log and a JSON-lines log beside the console.
+        if (const char* path = std::getenv("OPN_LOG_FILE")) {
+            auto sink = std::make_shared<RotatingFileSink>(path);
+            if (sink->isOpen()) Logger::addSink(std::move(sink));
+            else opn::logWarning("OPN Engine", "Could not open log file {}.", path);
+        }
+        if (const char* path = std::getenv("OPN_LOG_JSON")) {
+            auto sink = std::make_shared<JsonLinesSink>(path);
+            if (sink->isOpen()) Logger::addSink(std::move(sink));
+            else opn::logWarning("OPN Engine", "Could not open JSON log {}.", path);
+        }
         opn::logInfo("OPN Engine", "Starting engine...");
 
 #ifdef _WIN32
@@ -66,31 +86,62 @@ export namespace opn::detail {
                 std::move(checkFence)
             );
             Locator::registration::registerServiceManager(Services.getLocatorBridge());
+            profiling::registerReportSource(Services.getProfileBridge());
 
-            Services.registerServices();
+            Services.registerServices(&Jobs);
 
             logInfo("OPN Engine", "Engine initialized. Starting application: {}.", application->getName());
             application->onInit();
 
-            Services.postInitAll();
+            Services.postInitAll(&Jobs);
             application->onPostInit();
 
-            const auto* time = Locator::getService<Time>();
+            auto* time = Locator::getService<Time>();
             const auto* window = Locator::getService<WindowSystem>();
+            auto* rendering = Locator::getService<iRenderingService>();
+            auto* ecs = Locator::getService<EntityComponentSystem>();
 
+            // Init and post-init are not frame time, the first delta starts here.
+            time->resetFrameClock();
             while (!window->shouldClose()) {
-                const auto dt = static_cast<float>(time->getDeltaTime());
                 window->pollEvents();
 
-                Services.updateAll(dt);
+                time->beginFrame();
+                const auto dt = static_cast<float>(time->getDeltaTime());
+                Services.updatePhase(eUpdatePhase::PreFrame, dt, &Jobs);
+
+                // Simulation advances in fixed steps, independent of the frame rate and clamped per frame by Time.
+                const auto fixedDt = static_cast<float>(time->getFixedDeltaTime());
+                while (time->checkPhysicsStep()) {
+                    Services.updatePhase(eUpdatePhase::FixedStep, fixedDt, &Jobs);
+                    application->onFixedUpdate(fixedDt);
+                }
+
+                // From here on the frame sits between two fixed steps, see Time::getPhysicsInterpolationFactor().
+                Services.updatePhase(eUpdatePhase::Variable, dt, &Jobs);
                 application->onUpdate(dt);
+                // One draw list per frame, once everything has moved and before Rendering draws in PostFrame.
+                if (ecs) ecs->executeRenderSystems(static_cast<float>(time->getPhysicsInterpolationFactor()));
+                Services.updatePhase(eUpdatePhase::PostFrame, dt, &Jobs);
+
+                // VSync lets present block on the display; otherwise, and while minimised, Time holds the frame.
+                if (rendering) rendering->getBackend().setVSync(time->getFramePacing() == eFramePacing::VSync);
+                time->endFrame(window->isMinimised());
             }
 
             logInfo("OPN Engine", "Application closing.");
             application->onShutdown();
 
+            // Headless runs can point OPN_PROFILE_CSV at a file to keep the service timings.
+            if (const char* csvPath = std::getenv("OPN_PROFILE_CSV"); PROFILING_ENABLED && csvPath) {
+                if (profiling::writeCsv(csvPath)) logInfo("OPN Engine", "Service timings written to {}.", csvPath);
+                else logWarning("OPN Engine", "Could not write service timings to {}.", csvPath);
+            }
+
             logInfo("OPN Engine", "Shutting down...");
+            profiling::registerReportSource(nullptr);
             Services.shutdown();
+            Locator::registration::registerServiceManager(nullptr);
             Jobs.shutdown();
 
             logInfo("OPN Engine", "Application post-shutdown cleanup...");
@@ -30,7 +30,14 @@ export namespace opn {
         virtual void onPostInit() {};
 
         /**
-         * @brief Called every frame
+         * @brief Called at the fixed simulation rate, zero or more times per frame.
+         * Put gameplay and physics here so they do not depend on the frame rate.
+         */
+        virtual void onFixedUpdate(float _fixedDeltaTime) {};
+
+        /**
+         * @brief Called every frame, after the fixed steps.
+         * Blend simulation state with Time::getPhysicsInterpolationFactor() for smooth rendering.
          */
         virtual void onUpdate(float _deltaTime) {};
 
@@ -1,9 +1,11 @@
 module;
+#include <span>
 
 // THIS IS JUST KINDA HERE PLEASE IGNORE FOR NOW
 
 export module opn.Renderer.DirectX;
 import opn.Renderer.Backend;
+import opn.Renderer.Types;
 import opn.System.WindowSurfaceProvider;
 import opn.Utils.Logging;
 
@@ -34,8 +36,16 @@ export namespace opn {
             // TODO
         }
 
+        void submitDrawList(std::span<const sDrawRecord> /*_draws*/) override {
+            // TODO
+        }
+
         void bindToWindow(WindowSurfaceProvider & /*_window*/) override {
             // TODO
         }
+
+        void setVSync(bool /*_enabled*/) override {
+            // TODO
+        }
     };
 }
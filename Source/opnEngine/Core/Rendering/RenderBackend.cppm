@@ -1,3 +1,6 @@
+module;
+#include <span>
+
 export module opn.Renderer.Backend;
 import opn.Renderer.Types;
 import opn.System.WindowSurfaceProvider;
@@ -16,6 +19,17 @@ export namespace opn {
 
         virtual void drawWithReflection(const void *_rawData, const sShaderReflection &_reflection) = 0;
 
+        /**
+         * @brief Hands over the frame's sorted draw list in one call; the backend copies what it keeps.
+         */
+        virtual void submitDrawList(std::span<const sDrawRecord> _draws) = 0;
+
         virtual void bindToWindow(WindowSurfaceProvider &) = 0;
+
+        /**
+         * @brief Whether presenting waits for the display refresh. Cheap to call every frame, the
+         * swapchain is only rebuilt when the setting changes.
+         */
+        virtual void setVSync(bool _enabled) = 0;
     };
 }
@@ -4,6 +4,7 @@ module;
 #include <cstdint>
 #include <cstring>
 #include <typeindex>
+#include "hlsl++.h"
 
 export module opn.Renderer.Types;
 
@@ -84,4 +85,24 @@ export namespace opn {
             return seed;
         }
     };
+
+    /**
+     * @brief One packed draw, produced by render extraction and consumed by the backend.
+     *
+     * Mesh and material are 64-bit asset keys (sAssetHandleHasher of the handle), the backend
+     * resolves them to GPU resources. Records are sorted by sortKey before submission.
+     */
+    struct sDrawRecord {
+        uint64_t sortKey = 0;
+        uint64_t mesh = 0;
+        uint64_t material = 0;
+        hlslpp::float4x4 world = hlslpp::float4x4::identity();
+    };
+
+    /**
+     * @brief Material in the high half so draws sharing pipeline state end up adjacent, mesh below it.
+     */
+    [[nodiscard]] constexpr uint64_t makeDrawSortKey(const uint64_t _material, const uint64_t _mesh) noexcept {
+        return (_material & 0xFFFFFFFF00000000ull) | (_mesh >> 32);
+    }
 }
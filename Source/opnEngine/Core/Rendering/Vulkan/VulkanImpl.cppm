@@ -2,9 +2,10 @@ module;
 #include <atomic>
 #include <filesystem>
 #include <functional>
-#include <thread>
 #include <deque>
 #include <algorithm>
+#include <span>
+#include <vector>
 
 #include "hlsl++.h"
 
@@ -29,6 +30,7 @@ import opn.System.WindowSurfaceProvider;
 import opn.Rendering.Util.vk.vkUtil;
 import opn.Utils.Logging;
 import opn.Utils.Exceptions;
+import opn.System.Profiling;
 
 export namespace opn {
     class VulkanImpl final : public RenderBackend {
@@ -62,6 +64,9 @@ export namespace opn {
         uint32_t m_pendingHeight{0};
         constexpr static float RESIZE_DEBOUNCE_SECONDS = 0.067f;
 
+        bool m_vsync{ true };
+        bool m_presentModeChanged{ false };
+
         struct sDeletionQueue {
             std::deque<std::function<void()>> deleters;
 
@@ -134,6 +139,9 @@ export namespace opn {
         VkPipelineLayout m_meshPipelineLayout{ };
         vkUtil::sGPUMeshBuffers m_rectangle{ };
 
+        // Latest list from submitDrawList(), recorded into the geometry pass of the next draw().
+        std::vector<sDrawRecord> m_drawList;
+
         struct sImmediate {
             VkFence fence{ };
             VkCommandBuffer commandBuffer{ };
@@ -155,6 +163,8 @@ export namespace opn {
         std::vector< sComputeEffect > m_backgroundEffects{};
         int32_t m_currentBackgroundEffect = 0;
 
+        bool m_showServiceTimings = true;
+
         std::unordered_map<sPipelineSignature, VkPipelineLayout, sPipelineSignatureHash> m_pipelineLayoutCache;
 
         // -- Implementation --
@@ -300,7 +310,10 @@ export namespace opn {
                 .format = m_swapchainImageFormat,
                 .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
             } )
-            .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
+            // FIFO is always available, so it ends the fallbacks when vsync is off.
+            .set_desired_present_mode( m_vsync ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_MAILBOX_KHR )
+            .add_fallback_present_mode( VK_PRESENT_MODE_IMMEDIATE_KHR )
+            .add_fallback_present_mode( VK_PRESENT_MODE_FIFO_KHR )
             .set_desired_extent( width, height )
             .add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
             .set_old_swapchain( m_swapchain )
@@ -1245,11 +1258,14 @@ export namespace opn {
                 }
             }
 
-            if (!shouldRender()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(20));
-                return;
+            if( m_presentModeChanged && !m_pendingResize ) {
+                m_presentModeChanged = false;
+                createSwapchain();
             }
 
+            // Nothing to present to, e.g. minimised. The engine loop paces idle frames.
+            if (!shouldRender()) return;
+
             ImGui_ImplVulkan_NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
@@ -1269,6 +1285,8 @@ export namespace opn {
             }
             ImGui::End();
 
+            if constexpr (PROFILING_ENABLED) drawServiceTimings();
+
             ImGui::Render();
             draw();
         }
@@ -1342,6 +1360,8 @@ export namespace opn {
 
             startGeometry( command );
 
+            drawRecords( command );
+
             endGeometry( command );
 
             vkUtil::transition_image( command
@@ -1464,6 +1484,34 @@ export namespace opn {
             vkCmdDrawIndexed(cmd, 6, 1, 0, 0, 0);
         }
 
+        void submitDrawList(const std::span<const sDrawRecord> _draws) override {
+            m_drawList.assign(_draws.begin(), _draws.end());
+        }
+
+        void drawRecords( VkCommandBuffer _command ) {
+            if( m_drawList.empty() ) return;
+
+            vkCmdBindPipeline( _command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_meshPipeline );
+            vkCmdBindIndexBuffer( _command, m_rectangle.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32 );
+
+            // Mesh keys are not resolved to GPU buffers yet, every record draws the default rectangle.
+            for( const auto &record : m_drawList ) {
+                const vkUtil::sGPUDrawPushConstants pushConstants{
+                    .worldMatrix  = record.world,
+                    .vertexBuffer = m_rectangle.vertexBufferAddress
+                };
+
+                vkCmdPushConstants( _command
+                                  , m_meshPipelineLayout
+                                  , VK_SHADER_STAGE_VERTEX_BIT
+                                  , 0
+                                  , sizeof( vkUtil::sGPUDrawPushConstants )
+                                  , &pushConstants
+                );
+                vkCmdDrawIndexed( _command, 6, 1, 0, 0, 0 );
+            }
+        }
+
         void submitImmediate( std::function< void( VkCommandBuffer _command ) >&& _function ) {
 
             opn::logTrace("VulkanBackend", "Immediate command received.");
@@ -1514,6 +1562,37 @@ export namespace opn {
             opn::logTrace("VulkanBackend", "Submit finished.");
         }
 
+        void drawServiceTimings() {
+            if (!m_showServiceTimings) return;
+
+            if (ImGui::Begin("Service timings", &m_showServiceTimings)) {
+                const auto timings = profiling::report();
+                constexpr auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+
+                if (ImGui::BeginTable("services", 6, flags)) {
+                    ImGui::TableSetupColumn("Service");
+                    ImGui::TableSetupColumn("init ms");
+                    ImGui::TableSetupColumn("p50 ms");
+                    ImGui::TableSetupColumn("p95 ms");
+                    ImGui::TableSetupColumn("p99 ms");
+                    ImGui::TableSetupColumn("max ms");
+                    ImGui::TableHeadersRow();
+
+                    for (const auto& timing : timings) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn(); ImGui::TextUnformatted(timing.name.data(), timing.name.data() + timing.name.size());
+                        ImGui::TableNextColumn(); ImGui::Text("%.2f", timing.initMs + timing.postInitMs);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.update.p50);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.update.p95);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.update.p99);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.update.max);
+                    }
+                    ImGui::EndTable();
+                }
+            }
+            ImGui::End();
+        }
+
         [[nodiscard]] bool shouldRender() const {
             return m_swapchain != VK_NULL_HANDLE &&
                    m_windowHandle != nullptr &&
@@ -1597,5 +1676,12 @@ export namespace opn {
 
             completeInit();
         }
+
+        void setVSync( const bool _enabled ) override {
+            if( _enabled == m_vsync ) return;
+            m_vsync = _enabled;
+            m_presentModeChanged = true;
+            opn::logDebug( "VulkanBackend", "VSync {}.", _enabled ? "on" : "off" );
+        }
     };
 }
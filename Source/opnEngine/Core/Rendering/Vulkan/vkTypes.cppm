@@ -15,7 +15,6 @@ module;
 #include <array>
 #include <functional>
 #include <deque>
-#include <iostream>
 #include <source_location>
 
 #include <vulkan/vulkan.h>
@@ -25,6 +24,8 @@ module;
 
 export module opn.Rendering.Util.vk.vkTypes;
 
+import opn.Utils.Logging;
+
 export namespace opn::vkUtil {
 
 
@@ -156,8 +157,9 @@ export namespace opn::vkUtil {
                 filename = filename.substr(pos + 1);
             }
 
-            std::println(std::cerr, "[VULKAN ERROR] ( {}:{} ) - {} failed",
-                         filename, _ctx.location.line(), _ctx.operation);
+            opn::logCritical("Vulkan", "{} failed with VkResult {} ( {}:{} )",
+                             _ctx.operation, static_cast<int>(_result), filename, _ctx.location.line());
+            opn::Logger::fatal();
             std::abort();
         }
     }
@@ -113,6 +113,11 @@ export namespace opn {
         template<typename Command>
         sJobHandle submitAfter(uint32_t _dependencyFence, eJobType _type, Command &&_command);
 
+        /**
+         * @brief Threads draining the General queue; 0 means submitted work would never run.
+         */
+        [[nodiscard]] size_t workerCount() const noexcept { return s_workers.size(); }
+
         bool isFenceSignaled(const uint32_t _fenceID) noexcept {
             return s_fencePool[_fenceID % MAX_FENCES].load(std::memory_order_acquire) == 0;
         }
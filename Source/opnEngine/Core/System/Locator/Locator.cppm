@@ -1,7 +1,10 @@
 module;
+#include <atomic>
 #include <cstdint>
 #include <typeindex>
 #include <functional>
+#include <mutex>
+#include <vector>
 export module opn.Utils.Locator;
 import opn.System.Jobs.Types;
 import opn.System.Jobs.Handle;
@@ -19,11 +22,44 @@ namespace opn::Locator::detail {
     inline SubmitAfterFn s_submitAfterFn = nullptr;
     inline WaitFenceFn   s_waitFenceFn   = nullptr;
     inline CheckFenceFn  s_checkFenceFn  = nullptr;
+
+    // Resolved service per type, so getService<T>() is a single load after the first call.
+    template<typename T>
+    inline std::atomic<T*> s_cached{nullptr};
+
+    // Clears every filled s_cached<T>, run whenever the service manager changes.
+    inline std::mutex                      s_cacheMutex;
+    inline std::vector<void(*)()>          s_cacheResets;
+
+    inline void resetCache() {
+        std::lock_guard lock(s_cacheMutex);
+        for (const auto reset : s_cacheResets) reset();
+        s_cacheResets.clear();
+    }
+
+    template<typename T>
+    T* resolve() {
+        if (!s_serviceFn) return nullptr;
+
+        auto* service = static_cast<T*>(s_serviceFn(std::type_index(typeid(T))));
+        if (service) {
+            std::lock_guard lock(s_cacheMutex);
+            if (!s_cached<T>.exchange(service, std::memory_order_acq_rel)) {
+                s_cacheResets.push_back([] { s_cached<T>.store(nullptr, std::memory_order_release); });
+            }
+        }
+        return service;
+    }
 }
 
 export namespace opn::Locator::registration {
+    /**
+     * @brief Installs the service lookup and drops every cached service pointer.
+     * @note Pass nullptr once the services are shut down so nothing keeps a dangling pointer.
+     */
     void registerServiceManager(detail::ServiceFn _fn) {
         detail::s_serviceFn = std::move(_fn);
+        detail::resetCache();
     }
 
     void registerJobDispatcher(detail::SubmitFn _submit, detail::SubmitAfterFn _submitAfter,
@@ -36,10 +72,20 @@ export namespace opn::Locator::registration {
 }
 
 export namespace opn::Locator {
+    /**
+     * @brief Service of type T, or the one implementing interface T. nullptr until it is registered.
+     */
     template<typename T>
     T* getService() {
-        if (!detail::s_serviceFn) return nullptr;
-        return static_cast<T*>(detail::s_serviceFn(std::type_index(typeid(T))));
+        if (auto* service = detail::s_cached<T>.load(std::memory_order_acquire)) return service;
+        return detail::resolve<T>();
+    }
+
+    /**
+     * @brief False until the engine registers its JobDispatcher, e.g. in tools and benchmarks.
+     */
+    bool hasJobDispatcher() {
+        return detail::s_submitFn != nullptr;
     }
 
     sJobHandle submit(eJobType _type, std::move_only_function<void()> _fn) {
@@ -0,0 +1,184 @@
+module;
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Service timings are recorded unless the build turns them off, see OPN_ENABLE_PROFILING in the root CMakeLists.
+#ifndef OPN_PROFILE
+#define OPN_PROFILE 1
+#endif
+
+export module opn.System.Profiling;
+
+export namespace opn {
+    constexpr bool PROFILING_ENABLED = OPN_PROFILE != 0;
+
+    struct sTimingStats {
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float mean = 0.0f;
+        float max = 0.0f;
+        float last = 0.0f;
+        uint32_t samples = 0;
+    };
+
+    /**
+     * @brief The last WINDOW samples of one timing, in milliseconds.
+     *
+     * Recording is a single store; percentiles are computed from a sorted copy on request, so the
+     * cost stays with whoever reads the stats.
+     */
+    class RollingTimings {
+    public:
+        static constexpr uint32_t WINDOW = 256;
+
+        void record(const float _ms) noexcept {
+            m_samples[m_next % WINDOW] = _ms;
+            ++m_next;
+        }
+
+        [[nodiscard]] sTimingStats stats() const {
+            sTimingStats result;
+            result.samples = std::min(m_next, WINDOW);
+            if (result.samples == 0) return result;
+
+            std::array<float, WINDOW> sorted{};
+            std::copy_n(m_samples.begin(), result.samples, sorted.begin());
+            const auto used = std::span(sorted).first(result.samples);
+            std::ranges::sort(used);
+
+            const auto rank = [&](const float _q) {
+                return used[std::min<size_t>(static_cast<size_t>(_q * static_cast<float>(used.size())), used.size() - 1)];
+            };
+            float sum = 0.0f;
+            for (const float sample: used) sum += sample;
+
+            result.p50 = rank(0.50f);
+            result.p95 = rank(0.95f);
+            result.p99 = rank(0.99f);
+            result.mean = sum / static_cast<float>(used.size());
+            result.max = used.back();
+            result.last = m_samples[(m_next - 1) % WINDOW];
+            return result;
+        }
+
+    private:
+        std::array<float, WINDOW> m_samples{};
+        uint32_t m_next = 0;
+    };
+
+    struct sServiceTiming {
+        std::string_view name;
+        float initMs = 0.0f;
+        float postInitMs = 0.0f;
+        sTimingStats update;
+    };
+
+    /**
+     * @brief Per-service timings owned by the ServiceManager, indexed by ServiceList position.
+     *
+     * Each slot is only written by the thread running that service, so recording takes no lock.
+     * Read between update phases, e.g. from a PostFrame service or after the loop.
+     */
+    template<size_t Count, bool Enabled = PROFILING_ENABLED>
+    class ServiceProfiler {
+    public:
+        template<typename Func>
+        void timeUpdate(const size_t _index, Func &&_func) {
+            const auto start = std::chrono::steady_clock::now();
+            std::forward<Func>(_func)();
+            m_update[_index].record(
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        void recordInit(const size_t _index, const float _ms) noexcept { m_init[_index] = _ms; }
+        void recordPostInit(const size_t _index, const float _ms) noexcept { m_postInit[_index] = _ms; }
+
+        [[nodiscard]] sServiceTiming timing(const size_t _index, const std::string_view _name) const {
+            return {_name, m_init[_index], m_postInit[_index], m_update[_index].stats()};
+        }
+
+    private:
+        std::array<RollingTimings, Count> m_update{};
+        std::array<float, Count> m_init{};
+        std::array<float, Count> m_postInit{};
+    };
+
+    template<size_t Count>
+    class ServiceProfiler<Count, false> {
+    public:
+        template<typename Func>
+        void timeUpdate(size_t, Func &&_func) { std::forward<Func>(_func)(); }
+
+        void recordInit(size_t, float) noexcept {}
+        void recordPostInit(size_t, float) noexcept {}
+
+        [[nodiscard]] sServiceTiming timing(size_t, const std::string_view _name) const { return {_name}; }
+    };
+}
+
+namespace opn::profiling::detail {
+    using ReportFn = std::function<std::vector<sServiceTiming>()>;
+
+    inline ReportFn s_reportFn = nullptr;
+
+    // Quoted per RFC 4180, template names such as Foo<A, B> contain commas.
+    void writeCsvField(std::ostream &_out, const std::string_view _field) {
+        _out << '"';
+        for (const char c: _field) {
+            if (c == '"') _out << '"';
+            _out << c;
+        }
+        _out << '"';
+    }
+}
+
+export namespace opn::profiling {
+    /**
+     * @brief Installs where report() reads from, the engine's ServiceManager. nullptr clears it.
+     */
+    void registerReportSource(detail::ReportFn _fn) {
+        detail::s_reportFn = std::move(_fn);
+    }
+
+    /**
+     * @brief Current timings of every registered service, empty without a source or when profiling
+     * is compiled out.
+     */
+    [[nodiscard]] std::vector<sServiceTiming> report() {
+        if (!PROFILING_ENABLED || !detail::s_reportFn) return {};
+        return detail::s_reportFn();
+    }
+
+    void writeCsv(std::ostream &_out, const std::span<const sServiceTiming> _timings) {
+        _out << "service,init_ms,post_init_ms,update_p50_ms,update_p95_ms,update_p99_ms,update_mean_ms,update_max_ms,samples\n";
+        for (const auto &timing: _timings) {
+            detail::writeCsvField(_out, timing.name);
+            _out << ',' << timing.initMs << ',' << timing.postInitMs << ','
+                 << timing.update.p50 << ',' << timing.update.p95 << ',' << timing.update.p99 << ','
+                 << timing.update.mean << ',' << timing.update.max << ',' << timing.update.samples << '\n';
+        }
+    }
+
+    /**
+     * @brief Writes report() to _path as CSV, for headless runs.
+     * @return False if the file could not be written.
+     */
+    bool writeCsv(const std::filesystem::path &_path) {
+        std::ofstream file(_path, std::ios::trunc);
+        if (!file) return false;
+        const auto timings = report();
+        writeCsv(file, timings);
+        return static_cast<bool>(file);
+    }
+}
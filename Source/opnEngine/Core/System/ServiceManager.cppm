@@ -1,23 +1,144 @@
 module;
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <expected>
 #include <functional>
 #include <memory>
 #include <ranges>
 #include <source_location>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <tuple>
 #include <typeindex>
-#include <unordered_map>
+#include <type_traits>
 #include <vector>
 
 export module opn.System.ServiceManager;
 import opn.System.SystemTypeList;
 import opn.System.ServiceInterface;
+import opn.System.Jobs.Dispatcher;
+import opn.System.Jobs.Types;
+import opn.System.Profiling;
 import opn.Utils.Logging;
 import opn.Utils.Exceptions;
 
 export namespace opn {
+    namespace detail {
+        /**
+         * @brief Readable service type name for logs and profiling, e.g. "opn::TimeService".
+         * typeid().name() is mangled on GCC and Clang.
+         */
+        template<typename T>
+        constexpr std::string_view serviceTypeName() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+            constexpr std::string_view signature = __FUNCSIG__;
+            constexpr auto first = signature.find("serviceTypeName<") + 16;
+            constexpr auto last = signature.rfind(">(void)");
+            std::string_view name = signature.substr(first, last - first);
+            for (const std::string_view prefix: {"struct ", "class "}) {
+                if (name.starts_with(prefix)) name.remove_prefix(prefix.size());
+            }
+            return name;
+#else
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr auto first = signature.find("T = ") + 4;
+            constexpr auto last = signature.find_first_of(";]", first);
+            return signature.substr(first, last - first);
+#endif
+        }
+
+        /**
+         * @brief Services a service needs initialised before its own init(), declared as
+         * `using Dependencies = SystemTypeList<...>;`. Defaults to none.
+         */
+        template<typename T>
+        struct ServiceDependencies {
+            using type = SystemTypeList<>;
+        };
+
+        template<typename T> requires requires { typename T::Dependencies; }
+        struct ServiceDependencies<T> {
+            using type = typename T::Dependencies;
+        };
+
+        template<typename T>
+        constexpr eMainThread serviceMainThread() {
+            if constexpr (requires { T::RequiresMainThread; }) return T::RequiresMainThread;
+            else return eMainThread::None;
+        }
+
+        /**
+         * @brief Services T must not update concurrently with, declared as
+         * `using Conflicts = SystemTypeList<...>;`. Either side declaring it is enough.
+         */
+        template<typename T>
+        struct ServiceConflicts {
+            using type = SystemTypeList<>;
+        };
+
+        template<typename T> requires requires { typename T::Conflicts; }
+        struct ServiceConflicts<T> {
+            using type = typename T::Conflicts;
+        };
+
+        template<typename T>
+        constexpr eUpdatePhase serviceUpdatePhase() {
+            if constexpr (requires { T::UpdatePhase; }) return T::UpdatePhase;
+            else return eUpdatePhase::Variable;
+        }
+
+        template<typename T>
+        constexpr float serviceUpdateRate() {
+            if constexpr (requires { T::UpdateRate; }) return T::UpdateRate;
+            else return 0.0f;
+        }
+
+        template<typename List, typename... Cs>
+        constexpr bool conflictsListed(SystemTypeList<Cs...>) {
+            return (List::template contains<Cs>() && ...);
+        }
+
+        /**
+         * @brief True when T can also be looked up by the interface it implements, e.g. iRenderingService.
+         */
+        template<typename T>
+        constexpr bool hasServiceInterface() {
+            if constexpr (requires { typename T::InterfaceType; }) {
+                return !std::is_same_v<typename T::InterfaceType, iService>;
+            } else {
+                return false;
+            }
+        }
+
+        template<typename T>
+        constexpr size_t serviceLevel();
+
+        template<typename... Deps>
+        constexpr size_t levelAfter(SystemTypeList<Deps...>) {
+            return std::max({size_t{0}, (serviceLevel<Deps>() + 1)...});
+        }
+
+        /**
+         * @brief Topological level: 0 without dependencies, otherwise one past the deepest dependency.
+         */
+        template<typename T>
+        constexpr size_t serviceLevel() {
+            return levelAfter(typename ServiceDependencies<T>::type{});
+        }
+
+        // Requiring dependencies to be listed earlier keeps the graph acyclic and lets update and
+        // shutdown keep following list order.
+        template<typename List, typename T, typename... Deps>
+        constexpr bool dependenciesListedBefore(SystemTypeList<Deps...>) {
+            return ((List::template indexOf<Deps>() < List::template indexOf<T>()) && ...);
+        }
+    }
+
     template<typename ServiceList>
     class ServiceManager_Impl {
     public:
@@ -40,7 +161,7 @@ export namespace opn {
         };
 
         enum class ServiceError {
-            // The service wasn't found in the internal map
+            // The service hasn't been registered yet
             NotRegistered,
 
             // The service exists but init() or postInit() hasn't finished
@@ -64,6 +185,8 @@ export namespace opn {
         struct iServiceHolder {
             virtual ~iServiceHolder() = default;
 
+            virtual void init() = 0;
+
             virtual void shutdown() = 0;
 
             virtual void update(float _deltaTime) = 0;
@@ -72,6 +195,8 @@ export namespace opn {
 
             virtual iService *getRaw() = 0;
 
+            [[nodiscard]] virtual std::string_view name() const = 0;
+
             ServiceState state = ServiceState::Unregistered;
         };
 
@@ -84,7 +209,7 @@ export namespace opn {
                 service = std::make_unique<T>();
             }
 
-            void init() {
+            void init() override {
                 opn::logTrace("ServiceManager", "Initializing service...");
                 service->init();
             }
@@ -108,17 +233,96 @@ export namespace opn {
             T &get() { return *service; }
             const T &get() const { return *service; }
             iService *getRaw() override { return service.get(); }
+            [[nodiscard]] std::string_view name() const override { return detail::serviceTypeName<T>(); }
+        };
+
+        struct sServiceSchedule {
+            size_t level = 0;
+            eMainThread mainThread = eMainThread::None;
+            eUpdatePhase phase = eUpdatePhase::Variable;
+            float rate = 0.0f;
+            // Update batch within the phase, services in one batch run concurrently.
+            size_t batch = 0;
         };
 
+        static constexpr size_t PHASE_COUNT = static_cast<size_t>(eUpdatePhase::None);
+
+        // Per ServiceList entry, in list order.
+        static constexpr auto s_schedule = [] {
+            constexpr size_t count = ServiceList::size();
+            std::array<sServiceSchedule, count> schedule{};
+            std::array<std::array<bool, count>, count> conflicts{};
+            size_t index = 0;
+            ServiceList::forEach([&]<typename T>(std::type_identity<T>) {
+                schedule[index] = {detail::serviceLevel<T>(), detail::serviceMainThread<T>(),
+                                   detail::serviceUpdatePhase<T>(), detail::serviceUpdateRate<T>()};
+                [&]<typename... Cs>(SystemTypeList<Cs...>) {
+                    ((conflicts[index][ServiceList::template indexOf<Cs>()] = true), ...);
+                }(typename detail::ServiceConflicts<T>::type{});
+                ++index;
+            });
+
+            // Greedy batching in list order: a service goes one batch past the latest conflicting
+            // service before it in the same phase, so conflicting pairs keep their list order.
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (schedule[j].phase == schedule[i].phase && (conflicts[i][j] || conflicts[j][i])) {
+                        schedule[i].batch = std::max(schedule[i].batch, schedule[j].batch + 1);
+                    }
+                }
+            }
+            return schedule;
+        }();
+
+        // List indices of updating services ordered by (phase, batch), and each phase's range in it.
+        // None services are left out entirely.
+        static constexpr auto s_updateOrder = [] {
+            std::array<size_t, ServiceList::size()> order{};
+            std::array<std::pair<size_t, size_t>, PHASE_COUNT> ranges{};
+            size_t count = 0;
+            for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+                ranges[phase].first = count;
+                for (size_t batch = 0; batch < ServiceList::size(); ++batch) {
+                    for (size_t i = 0; i < ServiceList::size(); ++i) {
+                        if (static_cast<size_t>(s_schedule[i].phase) == phase && s_schedule[i].batch == batch) {
+                            order[count++] = i;
+                        }
+                    }
+                }
+                ranges[phase].second = count;
+            }
+            return std::pair{order, ranges};
+        }();
+
+        static constexpr size_t s_levelCount = [] {
+            size_t levels = 0;
+            for (const auto &entry: s_schedule) levels = std::max(levels, entry.level + 1);
+            return levels;
+        }();
+
+        template<typename... Ts>
+        using HolderTuple = std::tuple<std::unique_ptr<ServiceHolder<Ts> >...>;
+
         std::atomic_bool m_initialized{false};
-        std::unordered_map<std::type_index, std::unique_ptr<iServiceHolder> > m_services;
-        std::vector<std::type_index> m_initOrder;
+
+        // One slot per ServiceList entry, addressed by list index at compile time. m_holders mirrors
+        // the slots type-erased for the list-wide loops.
+        typename ServiceList::template apply<HolderTuple> m_services;
+        std::array<iServiceHolder *, ServiceList::size()> m_holders{};
+        std::vector<size_t> m_initOrder;
+        // Time accumulated by rate-limited services since their last update.
+        std::array<float, ServiceList::size()> m_pendingDelta{};
+        [[no_unique_address]] ServiceProfiler<ServiceList::size()> m_profiler;
 
         template<IsService T>
-        T &getServiceInternal() {
-            auto itr = m_services.find(typeid(T));
-            auto *holder = static_cast<ServiceHolder<T> *>(itr->second.get());
-            return holder->get();
+        static constexpr size_t indexOf() {
+            static_assert(ServiceList::template contains<T>(), "Service not in ServiceList.");
+            return ServiceList::template indexOf<T>();
+        }
+
+        template<IsService T>
+        ServiceHolder<T> *holderOf() const noexcept {
+            return std::get<indexOf<T>()>(m_services).get();
         }
 
     public:
@@ -136,56 +340,118 @@ export namespace opn {
                 return; // Already shut down or never initialized
             }
 
-            opn::logInfo("ServiceManager", "Shutting down {} services...", m_services.size());
+            opn::logInfo("ServiceManager", "Shutting down {} services...", getServiceCount());
 
-            for (auto &itr: std::ranges::reverse_view(m_initOrder)) {
-                auto servItr = m_services.find(itr);
-                if (servItr != m_services.end()) {
-                    servItr->second->shutdown();
-                }
+            for (const size_t index: std::ranges::reverse_view(m_initOrder)) {
+                m_holders[index]->shutdown();
             }
-            m_services.clear();
+            std::apply([](auto &... _holders) { (_holders.reset(), ...); }, m_services);
+            m_holders.fill(nullptr);
             m_initOrder.clear();
 
             opn::logInfo("ServiceManager", "All services shutdown successfully.");
         }
 
-        void updateAll(const float _deltaTime) {
+        /**
+         * @brief Runs one update phase. Batches run in order; within a batch, services go to _jobs
+         * while those requiring the main thread run inline. The first exception thrown by a service
+         * is rethrown once its batch has finished.
+         * @note Driving FixedStep, i.e. how many steps a frame takes, is up to the caller.
+         */
+        void updatePhase(const eUpdatePhase _phase, const float _deltaTime, JobDispatcher *_jobs = nullptr) {
+            if (_phase == eUpdatePhase::None) return;
             if (!m_initialized.load(std::memory_order_acquire)) {
                 opn::logWarning("ServiceManager", "Update called, but ServiceManager wasn't initialized.");
                 return;
             }
 
-            for (const auto &typeIndex: m_initOrder) {
-                auto itr = m_services.find(typeIndex);
-                if (itr != m_services.end()) {
-                    itr->second->update(_deltaTime);
+            const auto &[order, ranges] = s_updateOrder;
+            const auto [begin, end] = ranges[static_cast<size_t>(_phase)];
+
+            std::array<size_t, ServiceList::size()> due{};
+            std::array<std::exception_ptr, ServiceList::size()> errors{};
+            for (size_t first = begin; first < end;) {
+                const size_t batch = s_schedule[order[first]].batch;
+                size_t count = 0;
+                size_t last = first;
+                for (; last < end && s_schedule[order[last]].batch == batch; ++last) {
+                    const size_t index = order[last];
+                    if (m_holders[index] && consumeRate(index, _phase, _deltaTime)) due[count++] = index;
+                }
+                first = last;
+
+                runConcurrently(std::span<const size_t>(due.data(), count), eMainThread::Update, _jobs,
+                                [&](const size_t _index) {
+                                    try {
+                                        m_profiler.timeUpdate(_index, [&] {
+                                            m_holders[_index]->update(m_pendingDelta[_index]);
+                                        });
+                                    } catch (...) {
+                                        errors[_index] = std::current_exception();
+                                    }
+                                });
+
+                for (const size_t index: std::span<const size_t>(due.data(), count)) {
+                    if (s_schedule[index].rate > 0.0f) m_pendingDelta[index] = 0.0f;
+                    if (errors[index]) std::rethrow_exception(errors[index]);
                 }
             }
         }
 
-        void postInitAll() {
+        /**
+         * @brief Runs PreFrame, Variable and PostFrame back to back, skipping FixedStep.
+         */
+        void updateAll(const float _deltaTime, JobDispatcher *_jobs = nullptr) {
+            updatePhase(eUpdatePhase::PreFrame, _deltaTime, _jobs);
+            updatePhase(eUpdatePhase::Variable, _deltaTime, _jobs);
+            updatePhase(eUpdatePhase::PostFrame, _deltaTime, _jobs);
+        }
+
+        /**
+         * @brief Runs postInit() level by level, see registerServices() for the scheduling.
+         */
+        void postInitAll(JobDispatcher *_jobs = nullptr) {
             opn::logInfo("ServiceManager", "Post-Initializing services...");
             if (!m_initialized.load(std::memory_order_acquire)) {
                 opn::logWarning("ServiceManager", "PostInit called, but ServiceManager wasn't initialized.");
                 return;
             }
-            for (const auto &typeIndex: m_initOrder) {
-                auto itr = m_services.find(typeIndex);
-                if (itr != m_services.end()) {
-                    itr->second->postInit();
-                    itr->second->state = ServiceState::Ready;
-                }
-            }
+            runPhase(ServiceState::Initializing, ServiceState::Ready, _jobs);
             opn::logInfo("ServiceManager", "Post-Initialization complete.");
         }
 
-        iService *getRawService(std::type_index _type) {
-            auto itr = m_services.find(_type);
-            if (itr != m_services.end()) {
-                return itr->second->getRaw();
+        /**
+         * @brief Runtime lookup by type or implemented interface, a linear scan over the list.
+         * @note Only the Locator's first lookup per type lands here, it caches the result.
+         */
+        iService *getRawService(const std::type_index _type) {
+            iService *found = nullptr;
+            ServiceList::forEach([&]<typename T>(std::type_identity<T>) {
+                auto *holder = holderOf<T>();
+                if (found || !holder) return;
+
+                bool matches = _type == typeid(T);
+                if constexpr (detail::hasServiceInterface<T>()) matches |= _type == typeid(typename T::InterfaceType);
+                if (matches) found = holder->getRaw();
+            });
+            return found;
+        }
+
+        /**
+         * @brief init/postInit times and rolling update percentiles of every registered service.
+         * @note Read between update phases; all zero when profiling is compiled out.
+         */
+        [[nodiscard]] std::vector<sServiceTiming> profileReport() const {
+            std::vector<sServiceTiming> result;
+            result.reserve(m_initOrder.size());
+            for (const size_t index: m_initOrder) {
+                result.push_back(m_profiler.timing(index, m_holders[index]->name()));
             }
-            return nullptr;
+            return result;
+        }
+
+        std::function<std::vector<sServiceTiming>()> getProfileBridge() const {
+            return [this] { return this->profileReport(); };
         }
 
         std::function<opn::iService*(std::type_index)> getLocatorBridge() {
@@ -199,90 +465,205 @@ export namespace opn {
             static_assert(ServiceList::template contains<T>(),
                           "ERROR: Service not found in ServiceList.");
 
-            const auto typeIdx = std::type_index(typeid(T));
-
-            if (m_services.contains(typeIdx)) {
+            auto &slot = std::get<indexOf<T>()>(m_services);
+            if (slot) {
                 opn::logWarning("ServiceManager", "Service already registered. Returning existing instance.");
-                return getServiceInternal<T>();
+                return slot->get();
             }
 
-            auto holder = std::make_unique<ServiceHolder<T> >();
-            holder->state = ServiceState::Registered;
-            holder->init();
+            slot = std::make_unique<ServiceHolder<T> >();
+            slot->state = ServiceState::Registered;
+            slot->init();
+            slot->state = ServiceState::Initializing;
 
-            T &serviceRef = holder->get();
-            m_services.emplace(typeIdx, std::move(holder));
-            m_initOrder.emplace_back(typeIdx);
+            m_holders[indexOf<T>()] = slot.get();
+            m_initOrder.emplace_back(indexOf<T>());
 
             opn::logInfo("ServiceManager", "Service registered successfully.");
-            return serviceRef;
+            return slot->get();
         }
 
         template<IsService T>
         [[nodiscard]] bool isRegistered() const noexcept {
-            static_assert(ServiceList::template contains<T>(), "Service not in ServiceList.");
-            return m_services.contains(typeid(T));
+            return holderOf<T>() != nullptr;
         }
 
-        [[nodiscard]] size_t getServiceCount() const noexcept { return m_services.size(); }
+        [[nodiscard]] size_t getServiceCount() const noexcept { return m_initOrder.size(); }
 
         [[nodiscard]] std::vector<std::type_index> getServiceTypes() const noexcept {
             std::vector<std::type_index> result;
-            result.reserve(m_services.size());
-            for (const auto &[type, _]: m_services) {
-                result.emplace_back(type);
-            }
+            result.reserve(m_initOrder.size());
+            ServiceList::forEach([&]<typename T>(std::type_identity<T>) {
+                if (holderOf<T>()) result.emplace_back(typeid(T));
+            });
             return result;
         }
 
         template<IsService T>
         [[nodiscard]] T &getService() {
-            static_assert(ServiceList::template contains<T>(), "Service not in ServiceList.");
-
-            auto itr = m_services.find(typeid(T));
-            if (itr == m_services.end()) {
+            auto *holder = holderOf<T>();
+            if (!holder) {
                 opn::logCritical("ServiceManager", "Service not registered!");
                 throw std::runtime_error("Service not registered!");
             }
-
-            auto *holder = static_cast<ServiceHolder<T> *>(itr->second.get());
             return holder->get();
         }
 
         template<IsService T>
         [[nodiscard]] std::expected<std::reference_wrapper<T>, ServiceError> tryGetService() noexcept {
-            const auto typeIdx = std::type_index(typeid(T));
-            auto itr = m_services.find(typeIdx);
-
-            if (itr == m_services.end()) return std::unexpected(ServiceError::NotRegistered);
+            auto *holder = holderOf<T>();
 
-            const auto &holder = itr->second;
+            if (!holder) return std::unexpected(ServiceError::NotRegistered);
             if (holder->state == ServiceState::ShuttingDown) return std::unexpected(ServiceError::ShuttingDown);
             if (holder->state != ServiceState::Ready) return std::unexpected(ServiceError::NotInitialized);
 
-            auto *concreteHolder = static_cast<ServiceHolder<T> *>(holder.get());
-            return std::ref(concreteHolder->get());
+            return std::ref(holder->get());
         }
 
-        void registerServices() {
+        /**
+         * @brief Constructs every listed service, then runs init() one dependency level at a time.
+         *
+         * Within a level, services are handed to _jobs while the main thread runs those requiring it,
+         * so independent start-up work overlaps. Without a dispatcher (or workers) everything runs
+         * inline in list order. The first exception thrown by a service is rethrown once its level
+         * has finished.
+         */
+        void registerServices(JobDispatcher *_jobs = nullptr) {
             opn::logInfo("ServiceManager", "Registering services from declaration list.");
             ServiceList::forEach([this]<typename T>(std::type_identity<T>) {
                 if constexpr (IsService<T>) {
-                    this->registerService<T>();
+                    static_assert(detail::dependenciesListedBefore<ServiceList, T>(
+                                      typename detail::ServiceDependencies<T>::type{}),
+                                  "ERROR: Service dependencies must appear earlier in the ServiceList.");
+                    static_assert(detail::conflictsListed<ServiceList>(typename detail::ServiceConflicts<T>::type{}),
+                                  "ERROR: Service conflicts must name services in the ServiceList.");
+
+                    auto &slot = std::get<indexOf<T>()>(m_services);
+                    if (slot) return;
+
+                    slot = std::make_unique<ServiceHolder<T> >();
+                    slot->state = ServiceState::Registered;
+                    m_holders[indexOf<T>()] = slot.get();
+                    m_initOrder.emplace_back(indexOf<T>());
                 } else {
                     static_assert(IsService<T>, "Type in ServiceList does not inherit from iService!");
                 }
             });
-            opn::logInfo("ServiceManager", "{} services registered successfully.", m_services.size());
+
+            runPhase(ServiceState::Registered, ServiceState::Initializing, _jobs);
+            opn::logInfo("ServiceManager", "{} services registered successfully.", getServiceCount());
         }
 
+    private:
+        /**
+         * @brief Moves every service in state _from to _to by running init() or postInit() on it.
+         * Logs each service's time plus the phase's wall time against the summed (serial) time.
+         */
+        void runPhase(const ServiceState _from, const ServiceState _to, JobDispatcher *_jobs) {
+            using Clock = std::chrono::steady_clock;
+            const bool postInit = _from == ServiceState::Initializing;
+            const char *phaseName = postInit ? "postInit" : "init";
+            const eMainThread phase = postInit ? eMainThread::PostInit : eMainThread::Init;
+
+            std::array<iServiceHolder *, ServiceList::size()> holders{};
+            for (size_t i = 0; i < holders.size(); ++i) {
+                if (m_holders[i] && m_holders[i]->state == _from) holders[i] = m_holders[i];
+            }
+
+            std::array<double, ServiceList::size()> durations{};
+            std::array<std::exception_ptr, ServiceList::size()> errors{};
+            const auto run = [&](const size_t _index) {
+                const auto start = Clock::now();
+                try {
+                    if (postInit) holders[_index]->postInit();
+                    else holders[_index]->init();
+                    holders[_index]->state = _to;
+                } catch (...) {
+                    errors[_index] = std::current_exception();
+                }
+                durations[_index] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            };
+
+            const auto phaseStart = Clock::now();
+            std::array<size_t, ServiceList::size()> inLevel{};
+            for (size_t level = 0; level < s_levelCount; ++level) {
+                size_t count = 0;
+                for (size_t i = 0; i < holders.size(); ++i) {
+                    if (holders[i] && s_schedule[i].level == level) inLevel[count++] = i;
+                }
+                runConcurrently(std::span<const size_t>(inLevel.data(), count), phase, _jobs, run);
+
+                for (const auto &error: errors) {
+                    if (error) std::rethrow_exception(error);
+                }
+            }
+
+            double summed = 0.0;
+            for (size_t i = 0; i < holders.size(); ++i) {
+                if (!holders[i]) continue;
+                summed += durations[i];
+                if (postInit) m_profiler.recordPostInit(i, static_cast<float>(durations[i]));
+                else m_profiler.recordInit(i, static_cast<float>(durations[i]));
+                opn::logDebug("ServiceManager", "{} {} took {:.2f} ms (level {}).", holders[i]->name(), phaseName,
+                              durations[i], s_schedule[i].level);
+            }
+            const double wall = std::chrono::duration<double, std::milli>(Clock::now() - phaseStart).count();
+            opn::logInfo("ServiceManager", "Service {} finished in {:.2f} ms, {:.2f} ms if run serially.", phaseName,
+                         wall, summed);
+        }
+
+        /**
+         * @brief Runs _run for every index in _indices, worker-eligible ones on _jobs and the rest
+         * inline. Without a dispatcher (or workers) everything runs inline in order.
+         *
+         * When none of them needs the main thread it takes the last one itself instead of idling on
+         * fences, so a lone service never pays for a job round trip.
+         */
+        template<typename Func>
+        static void runConcurrently(const std::span<const size_t> _indices, const eMainThread _phase,
+                                    JobDispatcher *_jobs, Func &&_run) {
+            const bool parallel = _jobs && _jobs->workerCount() > 0 && _indices.size() > 1;
+            const auto onMainThread = [&](const size_t _index) {
+                return !parallel ||
+                       (static_cast<uint8_t>(s_schedule[_index].mainThread) & static_cast<uint8_t>(_phase)) != 0;
+            };
+
+            const bool mainIdle = std::ranges::none_of(_indices, onMainThread);
+            std::array<uint32_t, ServiceList::size()> fences{};
+            size_t fenceCount = 0;
+
+            // Hand off worker-eligible services first so the main thread's share overlaps with them.
+            for (const size_t index: _indices) {
+                if (onMainThread(index) || (mainIdle && index == _indices.back())) continue;
+                fences[fenceCount++] = _jobs->submit(eJobType::General, [&_run, index] { _run(index); }).fenceID;
+            }
+            for (const size_t index: _indices) {
+                if (onMainThread(index) || (mainIdle && index == _indices.back())) _run(index);
+            }
+            for (size_t i = 0; i < fenceCount; ++i) _jobs->waitForFence(fences[i]);
+        }
+
+        /**
+         * @brief Adds _deltaTime to the service's pending time and reports whether it is due.
+         */
+        bool consumeRate(const size_t _index, const eUpdatePhase _phase, const float _deltaTime) {
+            const float rate = s_schedule[_index].rate;
+            if (rate <= 0.0f || _phase == eUpdatePhase::FixedStep) {
+                m_pendingDelta[_index] = _deltaTime;
+                return true;
+            }
+            m_pendingDelta[_index] += _deltaTime;
+            return m_pendingDelta[_index] >= 1.0f / rate;
+        }
+
+    public:
         template<IsService T, typename Func>
         void useService(Func &&func) noexcept {
             if (auto result = tryGetService<T>(); result.has_value()) {
                 func(result->get());
             } else {
                 const ServiceError err = result.error();
-                std::string_view typeName = typeid(T).name();
+                constexpr std::string_view typeName = detail::serviceTypeName<T>();
 
                 switch (err) {
                     case ServiceError::NotRegistered: logError( "ServiceManager"
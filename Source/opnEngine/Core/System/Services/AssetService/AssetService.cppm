@@ -77,6 +77,9 @@ namespace opn {
         fastgltf::Parser m_gltfParser;
 
     public:
+        // Loads are driven by commands, so the service never needs a per-frame update.
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::None;
+
         [[nodiscard]] static CommandAssetLoad load(std::string path) {
             return CommandAssetLoad{std::move(path)};
         }
@@ -99,9 +102,6 @@ namespace opn {
             opn::logInfo("AssetService", "Shutdown successfully.");
         }
 
-        void onUpdate(float _deltaTime) override {
-        }
-
     private:
         std::unordered_map<std::string, sAssetDescriptor> m_assetRegistry;
 
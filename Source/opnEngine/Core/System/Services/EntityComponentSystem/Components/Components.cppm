@@ -1,4 +1,5 @@
 export module opn.ECS.Components;
 export import :Renderable;
 export import :Transform;
+export import :TransformSoA;
 export import :ShaderOverride;
\ No newline at end of file
@@ -1,3 +1,5 @@
+module;
+#include <string_view>
 export module opn.ECS.Components:Renderable;
 import opn.Assets.Types;
 
@@ -6,5 +8,7 @@ export namespace opn::components {
         sAssetHandle meshHandle;
         sAssetHandle materialHandle;
         bool visible{true};
+
+        static constexpr std::string_view SnapshotName = "opn.Renderable";
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 module;
+#include <string_view>
 #include "hlsl++.h"
 export module opn.ECS.Components:Transform;
 
@@ -8,11 +9,38 @@ export namespace opn::components {
         hlslpp::quaternion rotation{ 0.0f, 0.0f, 0.0f, 1.0f };
         hlslpp::float3     scale   { 1.0f, 1.0f, 1.0f };
 
+        static constexpr std::string_view SnapshotName = "opn.Transform";
+
+        // Plain-float form used by ECS snapshots, the hlslpp members are not trivially copyable.
+        struct sSnapshot {
+            float position[3];
+            float rotation[4];
+            float scale[3];
+        };
+
+        [[nodiscard]] sSnapshot toSnapshot() const {
+            sSnapshot snapshot{};
+            hlslpp::store( snapshot.position, position );
+            hlslpp::store( snapshot.rotation, rotation );
+            hlslpp::store( snapshot.scale, scale );
+            return snapshot;
+        }
+
+        [[nodiscard]] static Transform fromSnapshot( const sSnapshot &_snapshot ) {
+            const auto &s = _snapshot;
+            return {
+                .position = { s.position[0], s.position[1], s.position[2] },
+                .rotation = { s.rotation[0], s.rotation[1], s.rotation[2], s.rotation[3] },
+                .scale    = { s.scale[0], s.scale[1], s.scale[2] }
+            };
+        }
+
         [[nodiscard]] hlslpp::float4x4 getMatrix() const {
             auto T = hlslpp::float4x4::translation( position );
             auto R = hlslpp::float4x4( rotation );
             auto S = hlslpp::float4x4::scale( scale );
-            return T * R * S;
+            // hlslpp's operator* is component-wise; compose row-vector style (scale, rotate, translate).
+            return hlslpp::mul( hlslpp::mul( S, R ), T );
         };
     };
 }
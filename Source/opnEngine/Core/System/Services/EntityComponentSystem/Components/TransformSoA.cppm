@@ -0,0 +1,238 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define OPN_TRANSFORM_SSE
+#endif
+
+#if defined(OPN_ENABLE_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "hlsl++.h"
+export module opn.ECS.Components:TransformSoA;
+import :Transform;
+
+extern "C++" {
+    namespace opn::components::detail {
+        // Defined in TransformSoAAVX2.cpp, the only TU built with AVX2/FMA flags. hlslpp switches its own
+        // storage layout on __AVX__, so the flags must not leak into translation units that include it.
+        void buildWorldMatricesAVX2(const float *const *_streams, size_t _first, size_t _last, float *_out);
+    }
+}
+
+export namespace opn::components {
+    /**
+     * @brief Structure-of-arrays transform storage for batched world matrix builds.
+     *
+     * Streams are padded with identity transforms up to a multiple of LANE_WIDTH so the
+     * SIMD kernel can always load full registers.
+     */
+    struct TransformSoA {
+        static constexpr size_t LANE_WIDTH = 8;
+
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+
+        [[nodiscard]] size_t size() const noexcept { return m_count; }
+
+        void resize(const size_t _count) {
+            m_count = _count;
+            const size_t padded = (_count + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+
+            for (auto *stream: {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ})
+                stream->assign(padded, 0.0f);
+            for (auto *stream: {&rotationW, &scaleX, &scaleY, &scaleZ})
+                stream->assign(padded, 1.0f);
+        }
+
+        void set(const size_t _index, const Transform &_transform) {
+            float position[3], rotation[4], scale[3];
+            hlslpp::store(position, _transform.position);
+            hlslpp::store(rotation, _transform.rotation);
+            hlslpp::store(scale, _transform.scale);
+
+            positionX[_index] = position[0];
+            positionY[_index] = position[1];
+            positionZ[_index] = position[2];
+            rotationX[_index] = rotation[0];
+            rotationY[_index] = rotation[1];
+            rotationZ[_index] = rotation[2];
+            rotationW[_index] = rotation[3];
+            scaleX[_index] = scale[0];
+            scaleY[_index] = scale[1];
+            scaleZ[_index] = scale[2];
+        }
+
+        [[nodiscard]] Transform get(const size_t _index) const {
+            return {
+                .position = {positionX[_index], positionY[_index], positionZ[_index]},
+                .rotation = {rotationX[_index], rotationY[_index], rotationZ[_index], rotationW[_index]},
+                .scale = {scaleX[_index], scaleY[_index], scaleZ[_index]}
+            };
+        }
+
+        /**
+         * @brief Rebuilds the store from a dense AoS range, e.g. a Transform pool.
+         */
+        void assign(const std::span<const Transform> _transforms) {
+            resize(_transforms.size());
+            for (size_t i = 0; i < _transforms.size(); ++i) {
+                set(i, _transforms[i]);
+            }
+        }
+
+    private:
+        size_t m_count = 0;
+    };
+
+    namespace detail {
+        static_assert(sizeof(hlslpp::float4x4) == 16 * sizeof(float));
+
+#if defined(OPN_ENABLE_AVX2)
+        // The AVX2 kernel is built into every x86 binary, this keeps it off CPUs that cannot run it.
+        inline bool cpuHasAVX2() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            const bool fma = (info[2] & (1 << 12)) != 0;
+            const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            __cpuidex(info, 7, 0);
+            return fma && osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+        }
+#endif
+
+        // Row-vector convention, matches Transform::getMatrix(): rows 0-2 are the rotation
+        // rows scaled per axis, row 3 is the translation.
+        inline void buildWorldMatricesScalar(const TransformSoA &_soa, const size_t _first, const size_t _last,
+                                             float *_out) {
+            for (size_t i = _first; i < _last; ++i) {
+                const float x = _soa.rotationX[i], y = _soa.rotationY[i], z = _soa.rotationZ[i], w = _soa.rotationW[i];
+                const float sx = _soa.scaleX[i], sy = _soa.scaleY[i], sz = _soa.scaleZ[i];
+
+                float *m = _out + (i - _first) * 16;
+                m[0] = sx * (1.0f - 2.0f * (y * y + z * z));
+                m[1] = sx * 2.0f * (x * y + w * z);
+                m[2] = sx * 2.0f * (x * z - w * y);
+                m[3] = 0.0f;
+                m[4] = sy * 2.0f * (x * y - w * z);
+                m[5] = sy * (1.0f - 2.0f * (x * x + z * z));
+                m[6] = sy * 2.0f * (y * z + w * x);
+                m[7] = 0.0f;
+                m[8] = sz * 2.0f * (x * z + w * y);
+                m[9] = sz * 2.0f * (y * z - w * x);
+                m[10] = sz * (1.0f - 2.0f * (x * x + y * y));
+                m[11] = 0.0f;
+                m[12] = _soa.positionX[i];
+                m[13] = _soa.positionY[i];
+                m[14] = _soa.positionZ[i];
+                m[15] = 1.0f;
+            }
+        }
+
+#if defined(OPN_TRANSFORM_SSE)
+        inline void storeRows4(float *_base, const size_t _row, __m128 _a, __m128 _b, __m128 _c, __m128 _d) {
+            _MM_TRANSPOSE4_PS(_a, _b, _c, _d);
+            float *row = _base + _row * 4;
+            _mm_storeu_ps(row + 0 * 16, _a);
+            _mm_storeu_ps(row + 1 * 16, _b);
+            _mm_storeu_ps(row + 2 * 16, _c);
+            _mm_storeu_ps(row + 3 * 16, _d);
+        }
+
+        inline void buildWorldMatrices4(const TransformSoA &_soa, const size_t _i, float *_out) {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 two = _mm_set1_ps(2.0f);
+            const __m128 zero = _mm_setzero_ps();
+
+            const __m128 x = _mm_loadu_ps(&_soa.rotationX[_i]);
+            const __m128 y = _mm_loadu_ps(&_soa.rotationY[_i]);
+            const __m128 z = _mm_loadu_ps(&_soa.rotationZ[_i]);
+            const __m128 w = _mm_loadu_ps(&_soa.rotationW[_i]);
+
+            const __m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+            const __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+            const __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+            const __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+            const __m128 sx = _mm_loadu_ps(&_soa.scaleX[_i]);
+            const __m128 sy = _mm_loadu_ps(&_soa.scaleY[_i]);
+            const __m128 sz = _mm_loadu_ps(&_soa.scaleZ[_i]);
+
+            storeRows4(_out, 0,
+                       _mm_mul_ps(sx, _mm_sub_ps(one, _mm_add_ps(yy, zz))),
+                       _mm_mul_ps(sx, _mm_add_ps(xy, wz)),
+                       _mm_mul_ps(sx, _mm_sub_ps(xz, wy)), zero);
+            storeRows4(_out, 1,
+                       _mm_mul_ps(sy, _mm_sub_ps(xy, wz)),
+                       _mm_mul_ps(sy, _mm_sub_ps(one, _mm_add_ps(xx, zz))),
+                       _mm_mul_ps(sy, _mm_add_ps(yz, wx)), zero);
+            storeRows4(_out, 2,
+                       _mm_mul_ps(sz, _mm_add_ps(xz, wy)),
+                       _mm_mul_ps(sz, _mm_sub_ps(yz, wx)),
+                       _mm_mul_ps(sz, _mm_sub_ps(one, _mm_add_ps(xx, yy))), zero);
+            storeRows4(_out, 3, _mm_loadu_ps(&_soa.positionX[_i]), _mm_loadu_ps(&_soa.positionY[_i]),
+                       _mm_loadu_ps(&_soa.positionZ[_i]), one);
+        }
+#endif
+    }
+
+    /**
+     * @brief Builds world matrices for entities [_first, _first + _out.size()) of the store.
+     *
+     * Uses the 8-wide AVX2 kernel on CPUs with AVX2/FMA (built unless OPN_ENABLE_AVX2 is off),
+     * 4-wide SSE otherwise and a scalar loop on other targets. Results match Transform::getMatrix().
+     */
+    inline void buildWorldMatrices(const TransformSoA &_soa, const std::span<hlslpp::float4x4> _out,
+                                   const size_t _first = 0) {
+        auto *out = reinterpret_cast<float *>(_out.data());
+        const size_t last = _first + _out.size();
+        size_t i = _first;
+
+#if defined(OPN_ENABLE_AVX2)
+        static const bool avx2 = detail::cpuHasAVX2();
+        if (avx2) {
+            // Scalar head until the SIMD loads are lane aligned with the padded streams.
+            const size_t head = std::min(last, (_first + 7) / 8 * 8);
+            detail::buildWorldMatricesScalar(_soa, i, head, out);
+
+            const float *streams[] = {
+                _soa.positionX.data(), _soa.positionY.data(), _soa.positionZ.data(),
+                _soa.rotationX.data(), _soa.rotationY.data(), _soa.rotationZ.data(), _soa.rotationW.data(),
+                _soa.scaleX.data(), _soa.scaleY.data(), _soa.scaleZ.data()
+            };
+            detail::buildWorldMatricesAVX2(streams, head, last, out + (head - _first) * 16);
+            return;
+        }
+#endif
+
+#if defined(OPN_TRANSFORM_SSE)
+        constexpr size_t width = 4;
+        const size_t head = std::min(last, (_first + width - 1) / width * width);
+        detail::buildWorldMatricesScalar(_soa, i, head, out);
+        i = head;
+
+        for (; i + width <= last; i += width) {
+            detail::buildWorldMatrices4(_soa, i, out + (i - _first) * 16);
+        }
+
+        // Tail lanes read padding, build into scratch and copy the live ones out.
+        if (i < last) {
+            alignas(16) float scratch[width * 16];
+            detail::buildWorldMatrices4(_soa, i, scratch);
+            std::memcpy(out + (i - _first) * 16, scratch, (last - i) * 16 * sizeof(float));
+        }
+#else
+        detail::buildWorldMatricesScalar(_soa, i, last, out);
+#endif
+    }
+}
@@ -0,0 +1,90 @@
+#include <cstddef>
+#include <cstring>
+#include <immintrin.h>
+
+// Built with AVX2/FMA flags only when OPN_ENABLE_AVX2 is on, see CMakeLists.txt. Kept free of hlslpp
+// on purpose: it changes its matrix storage when __AVX__ is defined.
+namespace opn::components::detail {
+    namespace {
+        enum eStream : size_t {
+            PositionX, PositionY, PositionZ,
+            RotationX, RotationY, RotationZ, RotationW,
+            ScaleX, ScaleY, ScaleZ
+        };
+
+        // Writes row _row of entities 0..7 from four 8-wide columns, transposing 4x8 lanes into 8 float4 rows.
+        void storeRows8(float *_base, const size_t _row, const __m256 _a, const __m256 _b, const __m256 _c,
+                        const __m256 _d) {
+            const __m256 t0 = _mm256_unpacklo_ps(_a, _b);
+            const __m256 t1 = _mm256_unpackhi_ps(_a, _b);
+            const __m256 t2 = _mm256_unpacklo_ps(_c, _d);
+            const __m256 t3 = _mm256_unpackhi_ps(_c, _d);
+
+            const __m256 r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            float *row = _base + _row * 4;
+            _mm_storeu_ps(row + 0 * 16, _mm256_castps256_ps128(r0));
+            _mm_storeu_ps(row + 1 * 16, _mm256_castps256_ps128(r1));
+            _mm_storeu_ps(row + 2 * 16, _mm256_castps256_ps128(r2));
+            _mm_storeu_ps(row + 3 * 16, _mm256_castps256_ps128(r3));
+            _mm_storeu_ps(row + 4 * 16, _mm256_extractf128_ps(r0, 1));
+            _mm_storeu_ps(row + 5 * 16, _mm256_extractf128_ps(r1, 1));
+            _mm_storeu_ps(row + 6 * 16, _mm256_extractf128_ps(r2, 1));
+            _mm_storeu_ps(row + 7 * 16, _mm256_extractf128_ps(r3, 1));
+        }
+
+        void buildWorldMatrices8(const float *const *_streams, const size_t _i, float *_out) {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 two = _mm256_set1_ps(2.0f);
+            const __m256 zero = _mm256_setzero_ps();
+
+            const __m256 x = _mm256_loadu_ps(_streams[RotationX] + _i);
+            const __m256 y = _mm256_loadu_ps(_streams[RotationY] + _i);
+            const __m256 z = _mm256_loadu_ps(_streams[RotationZ] + _i);
+            const __m256 w = _mm256_loadu_ps(_streams[RotationW] + _i);
+
+            const __m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+            const __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+            const __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+            const __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+            const __m256 sx = _mm256_loadu_ps(_streams[ScaleX] + _i);
+            const __m256 sy = _mm256_loadu_ps(_streams[ScaleY] + _i);
+            const __m256 sz = _mm256_loadu_ps(_streams[ScaleZ] + _i);
+
+            storeRows8(_out, 0,
+                       _mm256_mul_ps(sx, _mm256_sub_ps(one, _mm256_add_ps(yy, zz))),
+                       _mm256_mul_ps(sx, _mm256_add_ps(xy, wz)),
+                       _mm256_mul_ps(sx, _mm256_sub_ps(xz, wy)), zero);
+            storeRows8(_out, 1,
+                       _mm256_mul_ps(sy, _mm256_sub_ps(xy, wz)),
+                       _mm256_mul_ps(sy, _mm256_sub_ps(one, _mm256_add_ps(xx, zz))),
+                       _mm256_mul_ps(sy, _mm256_add_ps(yz, wx)), zero);
+            storeRows8(_out, 2,
+                       _mm256_mul_ps(sz, _mm256_add_ps(xz, wy)),
+                       _mm256_mul_ps(sz, _mm256_sub_ps(yz, wx)),
+                       _mm256_mul_ps(sz, _mm256_sub_ps(one, _mm256_add_ps(xx, yy))), zero);
+            storeRows8(_out, 3,
+                       _mm256_loadu_ps(_streams[PositionX] + _i),
+                       _mm256_loadu_ps(_streams[PositionY] + _i),
+                       _mm256_loadu_ps(_streams[PositionZ] + _i), one);
+        }
+    }
+
+    void buildWorldMatricesAVX2(const float *const *_streams, const size_t _first, const size_t _last, float *_out) {
+        size_t i = _first;
+        for (; i + 8 <= _last; i += 8) {
+            buildWorldMatrices8(_streams, i, _out + (i - _first) * 16);
+        }
+
+        // Streams are padded to 8 lanes, so the tail group is safe to load; keep only the live matrices.
+        if (i < _last) {
+            alignas(32) float scratch[8 * 16];
+            buildWorldMatrices8(_streams, i, scratch);
+            std::memcpy(_out + (i - _first) * 16, scratch, (_last - i) * 16 * sizeof(float));
+        }
+    }
+}
@@ -1,77 +1,431 @@
 module;
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 export module opn.ECS:ECB;
 import :Registry;
 import :tEntity;
 
-namespace opn {
-    class Registry;
+#ifdef __cpp_lib_hardware_interference_size
+using std::hardware_destructive_interference_size;
+#else
+constexpr std::size_t hardware_destructive_interference_size = 64;
+#endif
 
-    using EntityAction = std::move_only_function<void(Registry &)>;
+export namespace opn {
+    namespace detail {
+        /**
+         * @brief Chunked bump allocator used by command buffer lanes.
+         *
+         * Blocks never move once allocated, so payloads constructed in place stay valid
+         * until reset(). Blocks are kept across resets, recording only allocates while
+         * the arena is still growing towards its steady-state size.
+         */
+        class LinearArena {
+            static constexpr size_t BLOCK_SIZE = 64 * 1024;
+            static constexpr size_t BLOCK_ALIGN = 64;
 
-    struct sECSCommand {
-        enum class eType { Create, Destroy, AddComponent } type;
+            struct sBlock {
+                std::byte *data = nullptr;
+                size_t size = 0;
+            };
 
-        tEntity entity;
-        EntityAction action;
+            std::vector<sBlock> m_blocks;
+            size_t m_block = 0;
+            size_t m_offset = 0;
 
-        sECSCommand(eType t, tEntity e, EntityAction &&act)
-            : type(t), entity(e), action(std::move(act)) {
-        }
+        public:
+            LinearArena() = default;
+
+            LinearArena(const LinearArena &) = delete;
 
-        static sECSCommand Create(tEntity e, std::vector<tEntity> &tracking) {
-            return {
-                eType::Create, e, [&tracking, e](Registry &reg) {
-                    reg.internal_registerCreate(e);
-                    tracking.push_back(e);
+            LinearArena &operator=(const LinearArena &) = delete;
+
+            ~LinearArena() {
+                for (const auto &block: m_blocks) {
+                    ::operator delete(block.data, std::align_val_t{BLOCK_ALIGN});
                 }
-            };
-        }
+            }
 
-        template<typename T>
-        static sECSCommand AddComponent(tEntity e, T &&component) {
-            return {
-                eType::AddComponent, e, [e, c = std::forward<T>(component)](Registry &reg) mutable {
-                    if (reg.isValid(e)) {
-                        reg.addComponent<T>(e, std::move(c));
+            [[nodiscard]] void *allocate(const size_t _size, const size_t _align) {
+                while (m_block < m_blocks.size()) {
+                    const auto &block = m_blocks[m_block];
+                    const size_t aligned = (m_offset + _align - 1) & ~(_align - 1);
+                    if (aligned + _size <= block.size) {
+                        m_offset = aligned + _size;
+                        return block.data + aligned;
                     }
+                    ++m_block;
+                    m_offset = 0;
                 }
-            };
-        }
 
-        static sECSCommand Destroy(tEntity e, std::vector<tEntity> &tracking) {
-            return {
-                eType::Destroy, e, [&tracking, e](Registry &reg) {
-                    reg.internalDestroy(e);
-                    std::erase(tracking, e);
+                const size_t size = std::max(BLOCK_SIZE, _size);
+                auto *data = static_cast<std::byte *>(::operator new(size, std::align_val_t{BLOCK_ALIGN}));
+                m_blocks.push_back({data, size});
+                m_block = m_blocks.size() - 1;
+                m_offset = _size;
+                return data;
+            }
+
+            void reset() noexcept {
+                m_block = 0;
+                m_offset = 0;
+            }
+
+            /**
+             * @brief Frees every block once the arena holds more than _maxBytes, so a past peak is not
+             * kept forever. Only call right after reset().
+             */
+            void trim(const size_t _maxBytes) noexcept {
+                if (capacity() <= _maxBytes) return;
+                for (const auto &block: m_blocks) {
+                    ::operator delete(block.data, std::align_val_t{BLOCK_ALIGN});
                 }
-            };
+                m_blocks.clear();
+                reset();
+            }
+
+            [[nodiscard]] size_t capacity() const noexcept {
+                size_t total = 0;
+                for (const auto &block: m_blocks) total += block.size;
+                return total;
+            }
+
+            void swap(LinearArena &_other) noexcept {
+                m_blocks.swap(_other.m_blocks);
+                std::swap(m_block, _other.m_block);
+                std::swap(m_offset, _other.m_offset);
+            }
+
+            static constexpr size_t maxAlignment() { return BLOCK_ALIGN; }
+        };
+    }
+
+    class EntityCommandBuffer;
+
+    enum class eECSCommand : uint8_t {
+        // Order matters, playback applies commands phase by phase in this order.
+        Create,
+        AddComponent,
+        Destroy
+    };
+
+    struct sECSCommandHeader;
+
+    /**
+     * @brief Per component type playback table, one static instance per T.
+     */
+    struct sECSComponentOps {
+        // Applies a run of AddComponent commands for one type and consumes their payloads.
+        void (*insertRun)(Registry &, const sECSCommandHeader *, size_t);
+        // Destroys payloads that will never be played back, nullptr for trivial types.
+        void (*discard)(void *, size_t);
+    };
+
+    /**
+     * @brief POD command record. Payloads live in the recording lane's arena.
+     *
+     * Batched commands set `entities` to an arena copy of `count` handles and the payload
+     * to `count` contiguous components, single commands use `entity` directly.
+     */
+    struct sECSCommandHeader {
+        uint64_t sortKey;
+        tEntity entity;
+        eECSCommand type;
+        uint32_t count;
+        const tEntity *entities;
+        const sECSComponentOps *ops;
+        void *payload;
+
+        [[nodiscard]] std::span<const tEntity> targets() const noexcept {
+            return entities ? std::span(entities, count) : std::span(&entity, 1);
         }
     };
 
+    static_assert(std::is_trivially_copyable_v<sECSCommandHeader>);
+
+    /**
+     * @brief Deferred structural changes for a Registry.
+     *
+     * Every recording thread gets its own lane (header list + linear arena) so producers
+     * never contend with each other. The lane mutex is only ever contended by playback.
+     * Playback sorts all commands by phase and component type, then applies each
+     * component run as one batched insert into its pool.
+     *
+     * @note Commands from a single thread keep their relative order, ordering between
+     *       threads is unspecified.
+     */
     class EntityCommandBuffer {
-        mutable std::vector<sECSCommand> m_commands;
-                std::vector<sECSCommand> m_playbackBuffer;
-        mutable std::mutex m_mutex;
+        struct alignas(hardware_destructive_interference_size) sLane {
+            std::mutex mutex;
+            std::vector<sECSCommandHeader> commands;
+            detail::LinearArena arena;
+
+            // Swapped in during playback so recording can continue on the live buffers.
+            std::vector<sECSCommandHeader> playbackCommands;
+            detail::LinearArena playbackArena;
+
+            uint32_t laneIndex = 0;
+            uint32_t sequence = 0;
+        };
+
+        struct sLaneCache {
+            uint64_t owner = 0;
+            sLane *lane = nullptr;
+        };
+
+        static constexpr uint64_t PHASE_SHIFT = 62;
+        static constexpr uint64_t COMPONENT_SHIFT = 40;
+        static constexpr uint64_t LANE_SHIFT = 28;
+        static constexpr uint64_t SEQUENCE_MASK = (1ull << LANE_SHIFT) - 1;
+
+        inline static std::atomic<uint64_t> s_nextInstanceId{1};
+
+        const uint64_t m_instanceId = s_nextInstanceId.fetch_add(1, std::memory_order_relaxed);
+
+        std::mutex m_laneMutex;
+        std::vector<std::unique_ptr<sLane> > m_lanes;
+        std::vector<std::thread::id> m_laneOwners;
+
+        std::vector<sECSCommandHeader> m_sorted;
 
     public:
-        void enqueue(sECSCommand &&_command) const {
-            std::scoped_lock lock(m_mutex);
-            m_commands.emplace_back(std::move(_command));
+        EntityCommandBuffer() = default;
+
+        EntityCommandBuffer(const EntityCommandBuffer &) = delete;
+
+        EntityCommandBuffer &operator=(const EntityCommandBuffer &) = delete;
+
+        ~EntityCommandBuffer() {
+            for (const auto &lane: m_lanes) {
+                discardAll(lane->commands);
+                discardAll(lane->playbackCommands);
+            }
+        }
+
+        void create(const tEntity _entity) {
+            record(eECSCommand::Create, 0, _entity, nullptr, nullptr);
+        }
+
+        void create(const std::span<const tEntity> _entities) {
+            if (_entities.empty()) return;
+
+            sLane &lane = localLane();
+            std::scoped_lock lock(lane.mutex);
+            push(lane, eECSCommand::Create, 0, NULL_ENTITY, nullptr, nullptr, copyEntities(lane, _entities));
+        }
+
+        void destroy(const tEntity _entity) {
+            record(eECSCommand::Destroy, 0, _entity, nullptr, nullptr);
+        }
+
+        template<typename T>
+        void addComponent(const tEntity _entity, T &&_component) {
+            using Component = std::decay_t<T>;
+            static_assert(alignof(Component) <= detail::LinearArena::maxAlignment(),
+                          "Component alignment exceeds command arena alignment.");
+
+            sLane &lane = localLane();
+            std::scoped_lock lock(lane.mutex);
+
+            void *payload = lane.arena.allocate(sizeof(Component), alignof(Component));
+            if constexpr (std::is_trivially_copyable_v<Component>) {
+                std::memcpy(payload, &_component, sizeof(Component));
+            } else {
+                ::new(payload) Component(std::forward<T>(_component));
+            }
+            push(lane, eECSCommand::AddComponent, detail::componentTypeId<Component>(), _entity,
+                 &s_ops<Component>, payload);
+        }
+
+        /**
+         * @brief Records one command carrying a component for each entity.
+         * @note _entities and _components must be the same length.
+         */
+        template<typename T>
+        void addComponents(const std::span<const tEntity> _entities, const std::span<const T> _components) {
+            static_assert(alignof(T) <= detail::LinearArena::maxAlignment(),
+                          "Component alignment exceeds command arena alignment.");
+            if (_entities.empty()) return;
+
+            sLane &lane = localLane();
+            std::scoped_lock lock(lane.mutex);
+
+            const size_t count = std::min(_entities.size(), _components.size());
+            void *payload = lane.arena.allocate(sizeof(T) * count, alignof(T));
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                std::memcpy(payload, _components.data(), sizeof(T) * count);
+            } else {
+                std::uninitialized_copy_n(_components.data(), count, static_cast<T *>(payload));
+            }
+            push(lane, eECSCommand::AddComponent, detail::componentTypeId<T>(), NULL_ENTITY,
+                 &s_ops<T>, payload, copyEntities(lane, _entities.first(count)));
         }
 
         void playback(Registry &_registry) {
-            { // Swap magic for fast lock
-                std::scoped_lock lock(m_mutex);
-                m_playbackBuffer.swap(m_commands);
+            m_sorted.clear();
+            {
+                std::scoped_lock lanesLock(m_laneMutex);
+                for (const auto &lane: m_lanes) {
+                    { // Swap magic for fast lock
+                        std::scoped_lock lock(lane->mutex);
+                        lane->playbackCommands.swap(lane->commands);
+                        lane->playbackArena.swap(lane->arena);
+                        lane->sequence = 0;
+                    }
+                    m_sorted.insert(m_sorted.end(), lane->playbackCommands.begin(), lane->playbackCommands.end());
+                }
+            }
+
+            std::ranges::sort(m_sorted, {}, &sECSCommandHeader::sortKey);
+
+            const size_t count = m_sorted.size();
+            size_t first = 0;
+            while (first < count) {
+                const sECSCommandHeader &head = m_sorted[first];
+                const uint64_t runKey = head.sortKey >> COMPONENT_SHIFT;
+
+                size_t last = first + 1;
+                while (last < count && (m_sorted[last].sortKey >> COMPONENT_SHIFT) == runKey) ++last;
+
+                switch (head.type) {
+                    case eECSCommand::Create:
+                        for (size_t i = first; i < last; ++i) {
+                            if (m_sorted[i].entities) _registry.internal_registerCreate(m_sorted[i].targets());
+                            else _registry.internal_registerCreate(m_sorted[i].entity);
+                        }
+                        break;
+                    case eECSCommand::AddComponent:
+                        head.ops->insertRun(_registry, &m_sorted[first], last - first);
+                        break;
+                    case eECSCommand::Destroy:
+                        for (size_t i = first; i < last; ++i) _registry.internalDestroy(m_sorted[i].entity);
+                        break;
+                }
+                first = last;
+            }
+
+            // Indices destroyed above become reusable by create() from here on.
+            _registry.publishFreeList();
+
+            std::scoped_lock lanesLock(m_laneMutex);
+            for (const auto &lane: m_lanes) {
+                lane->playbackCommands.clear();
+                lane->playbackArena.reset();
+            }
+        }
+
+    private:
+        template<typename T>
+        static void insertRun(Registry &_registry, const sECSCommandHeader *_commands, const size_t _count) {
+            auto *pool = _registry.getPool<T>();
+
+            size_t total = 0;
+            for (size_t i = 0; i < _count; ++i) total += _commands[i].count;
+            pool->reserve(pool->size() + total);
+
+            for (size_t i = 0; i < _count; ++i) {
+                const auto &command = _commands[i];
+                T *components = static_cast<T *>(command.payload);
+                const auto targets = command.targets();
+
+                if (std::ranges::all_of(targets, [&](const tEntity _e) { return _registry.isValid(_e); })) {
+                    pool->insertBatch(targets, components);
+                } else {
+                    for (size_t c = 0; c < targets.size(); ++c) {
+                        if (_registry.isValid(targets[c])) pool->insert(targets[c], std::move(components[c]));
+                    }
+                }
+
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    std::destroy_n(components, command.count);
+                }
+            }
+        }
+
+        template<typename T>
+        static void discardPayload(void *_payload, const size_t _count) {
+            std::destroy_n(static_cast<T *>(_payload), _count);
+        }
+
+        template<typename T>
+        inline static constexpr sECSComponentOps s_ops{
+            &insertRun<T>,
+            std::is_trivially_destructible_v<T> ? nullptr : &discardPayload<T>
+        };
+
+        static void discardAll(std::vector<sECSCommandHeader> &_commands) {
+            for (const auto &command: _commands) {
+                if (command.ops && command.ops->discard) command.ops->discard(command.payload, command.count);
             }
-            for (auto &command: m_playbackBuffer) {
-                if (command.action) [[likely]] {
-                    command.action(_registry);
+            _commands.clear();
+        }
+
+        void record(const eECSCommand _type, const uint32_t _componentId, const tEntity _entity,
+                    const sECSComponentOps *_ops, void *_payload) {
+            sLane &lane = localLane();
+            std::scoped_lock lock(lane.mutex);
+            push(lane, _type, _componentId, _entity, _ops, _payload);
+        }
+
+        static std::span<const tEntity> copyEntities(sLane &_lane, const std::span<const tEntity> _entities) {
+            void *data = _lane.arena.allocate(_entities.size_bytes(), alignof(tEntity));
+            std::memcpy(data, _entities.data(), _entities.size_bytes());
+            return {static_cast<const tEntity *>(data), _entities.size()};
+        }
+
+        static void push(sLane &_lane, const eECSCommand _type, const uint32_t _componentId, const tEntity _entity,
+                         const sECSComponentOps *_ops, void *_payload,
+                         const std::span<const tEntity> _batch = {}) {
+            // phase | component | lane | sequence, unique per command so an unstable sort
+            // still preserves per-thread recording order.
+            const uint64_t key = static_cast<uint64_t>(_type) << PHASE_SHIFT
+                                 | static_cast<uint64_t>(_componentId & 0x3FFFFF) << COMPONENT_SHIFT
+                                 | static_cast<uint64_t>(_lane.laneIndex & 0xFFF) << LANE_SHIFT
+                                 | (_lane.sequence++ & SEQUENCE_MASK);
+
+            const auto count = _batch.empty() ? 1u : static_cast<uint32_t>(_batch.size());
+            _lane.commands.push_back({
+                key, _entity, _type, count, _batch.empty() ? nullptr : _batch.data(), _ops, _payload
+            });
+        }
+
+        sLane &localLane() {
+            thread_local sLaneCache t_cache;
+            if (t_cache.owner == m_instanceId) [[likely]] {
+                return *t_cache.lane;
+            }
+
+            std::scoped_lock lock(m_laneMutex);
+            const auto thisThread = std::this_thread::get_id();
+
+            sLane *lane = nullptr;
+            for (size_t i = 0; i < m_laneOwners.size(); ++i) {
+                if (m_laneOwners[i] == thisThread) {
+                    lane = m_lanes[i].get();
+                    break;
                 }
             }
-            m_playbackBuffer.clear();
+
+            if (!lane) {
+                m_lanes.push_back(std::make_unique<sLane>());
+                m_laneOwners.push_back(thisThread);
+                lane = m_lanes.back().get();
+                lane->laneIndex = static_cast<uint32_t>(m_lanes.size() - 1);
+            }
+
+            t_cache = {m_instanceId, lane};
+            return *lane;
         }
     };
 }
@@ -1,5 +1,12 @@
 export module opn.ECS;
+export import :tEntity;
 export import :Registry;
+export import :Hierarchy;
+export import :Snapshot;
+export import :Spatial;
+export import :Interpolation;
+export import :World;
+export import :RenderExtraction;
 export import :Service;
 export import :Systems;
 export import opn.ECS.Components;
\ No newline at end of file
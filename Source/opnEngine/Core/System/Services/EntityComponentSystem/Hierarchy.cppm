@@ -0,0 +1,231 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "hlsl++.h"
+export module opn.ECS:Hierarchy;
+import :Registry;
+import :tEntity;
+import opn.ECS.Components;
+import opn.Utils.Logging;
+
+export namespace opn {
+    namespace components {
+        /**
+         * @brief Parent link for hierarchical transforms.
+         *
+         * Only parent is user-facing; the rest is maintained by systems::TransformHierarchy,
+         * which keeps the pool sorted depth-first so a parent always precedes its subtree.
+         */
+        struct Hierarchy {
+            tEntity parent = NULL_ENTITY;
+
+            hlslpp::float4x4 world = hlslpp::float4x4::identity();
+            uint32_t parentIndex = 0xFFFFFFFF;
+            uint32_t subtreeSize = 1;
+            bool dirty = true;
+            bool subtreeDirty = true;
+
+            static constexpr std::string_view SnapshotName = "opn.Hierarchy";
+
+            // Only the link is persisted, ordering and world matrices are rebuilt after a restore.
+            struct sSnapshot {
+                tEntity parent;
+            };
+
+            [[nodiscard]] sSnapshot toSnapshot() const { return {parent}; }
+            [[nodiscard]] static Hierarchy fromSnapshot(const sSnapshot &_snapshot) { return {.parent = _snapshot.parent}; }
+
+            void remapEntities(const EntityRemap &_remap) {
+                parent = _remap(parent);
+                dirty = true;
+            }
+        };
+    }
+
+    namespace systems {
+        /**
+         * @brief Resolves world matrices for every entity with a Hierarchy component.
+         *
+         * The Hierarchy pool is re-sorted into depth-first pre-order only when the pool changed,
+         * after which update() is a single forward pass that skips subtrees with no dirty node.
+         * Transforms modified since the previous update are picked up from the change log; rebuilt
+         * nodes are stamped as changed so consumers can follow changed<Hierarchy>.
+         */
+        class TransformHierarchy final {
+            static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+            Registry *m_registry = nullptr;
+            uint64_t m_sortedVersion = ~0ull;
+            uint32_t m_lastTick = 0;
+
+            // Scratch reused across rebuilds.
+            std::vector<uint32_t> m_childStart;
+            std::vector<uint32_t> m_children;
+            std::vector<uint32_t> m_order;
+            std::vector<uint32_t> m_newIndex;
+            std::vector<uint32_t> m_stack;
+
+        public:
+            explicit TransformHierarchy(Registry &_registry)
+                : m_registry(&_registry) {}
+
+            /**
+             * @brief Flags an entity's local transform as changed and marks its ancestors as having
+             * a dirty subtree. No-op for entities without a Hierarchy component.
+             */
+            void markDirty(const tEntity _entity) {
+                auto *pool = m_registry->getPool<components::Hierarchy>();
+                auto *node = pool->get(_entity);
+                if (!node) return;
+
+                node->dirty = true;
+                for (tEntity parent = node->parent; !parent.is_null();) {
+                    auto *ancestor = pool->get(parent);
+                    if (!ancestor || ancestor->subtreeDirty) break;
+                    ancestor->subtreeDirty = true;
+                    parent = ancestor->parent;
+                }
+            }
+
+            void update() {
+                auto *pool = m_registry->getPool<components::Hierarchy>();
+                if (pool->version() != m_sortedVersion) rebuildOrder(*pool);
+
+                m_registry->forEachChanged<components::Transform>(
+                    m_lastTick, [this](const tEntity _entity, const components::Transform &) { markDirty(_entity); });
+                m_lastTick = m_registry->advanceTick();
+
+                auto *transforms = m_registry->getPool<components::Transform>();
+                auto &nodes = pool->components();
+                const auto &entities = pool->entities();
+
+                // Nodes below a dirty node inherit a new parent matrix and must be rebuilt too.
+                size_t forcedEnd = 0;
+                for (size_t i = 0; i < nodes.size();) {
+                    auto &node = nodes[i];
+                    const bool recompute = node.dirty || i < forcedEnd;
+
+                    if (!recompute && !node.subtreeDirty) {
+                        i += node.subtreeSize;
+                        continue;
+                    }
+
+                    if (recompute) {
+                        const auto *transform = transforms->get(entities[i]);
+                        const auto local = transform ? transform->getMatrix() : hlslpp::float4x4::identity();
+
+                        node.world = node.parentIndex == NO_PARENT
+                                         ? local
+                                         : hlslpp::mul(local, nodes[node.parentIndex].world);
+
+                        if (node.dirty) forcedEnd = std::max(forcedEnd, i + node.subtreeSize);
+                        pool->markChangedAt(static_cast<uint32_t>(i));
+                    }
+
+                    node.dirty = false;
+                    node.subtreeDirty = false;
+                    ++i;
+                }
+            }
+
+            [[nodiscard]] uint32_t lastTick() const noexcept { return m_lastTick; }
+
+            [[nodiscard]] const hlslpp::float4x4 *getWorld(const tEntity _entity) {
+                const auto *node = m_registry->getPool<components::Hierarchy>()->get(_entity);
+                return node ? &node->world : nullptr;
+            }
+
+        private:
+            void rebuildOrder(detail::ComponentPool<components::Hierarchy> &_pool) {
+                auto &nodes = _pool.components();
+                const auto &entities = _pool.entities();
+
+                // Parents must be nodes themselves; dangling links become roots. Indexing (not iterators)
+                // because inserting a missing parent may grow the pool.
+                for (size_t i = 0; i < nodes.size(); ++i) {
+                    const tEntity parent = nodes[i].parent;
+                    if (parent.is_null()) continue;
+
+                    if (parent == entities[i] || !m_registry->isValid(parent)) {
+                        nodes[i].parent = NULL_ENTITY;
+                    } else if (!_pool.has(parent)) {
+                        _pool.insert(parent, components::Hierarchy{});
+                    }
+                }
+
+                const auto count = static_cast<uint32_t>(nodes.size());
+
+                // Children grouped per parent (CSR), keeping the current relative order stable.
+                m_childStart.assign(count + 1, 0);
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!nodes[i].parent.is_null()) ++m_childStart[_pool.denseIndex(nodes[i].parent) + 1];
+                }
+                for (uint32_t i = 0; i < count; ++i) m_childStart[i + 1] += m_childStart[i];
+
+                m_children.resize(m_childStart[count]);
+                m_stack.assign(m_childStart.begin(), m_childStart.end() - 1);
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (!nodes[i].parent.is_null()) m_children[m_stack[_pool.denseIndex(nodes[i].parent)]++] = i;
+                }
+
+                m_order.clear();
+                m_order.reserve(count);
+                m_newIndex.assign(count, NO_PARENT);
+
+                const auto visit = [&](const uint32_t _root) {
+                    m_stack.clear();
+                    m_stack.push_back(_root);
+                    while (!m_stack.empty()) {
+                        const uint32_t current = m_stack.back();
+                        m_stack.pop_back();
+                        if (m_newIndex[current] != NO_PARENT) continue;
+
+                        m_newIndex[current] = static_cast<uint32_t>(m_order.size());
+                        m_order.push_back(current);
+
+                        // Reverse push so children come out in their original order.
+                        for (uint32_t c = m_childStart[current + 1]; c > m_childStart[current]; --c) {
+                            m_stack.push_back(m_children[c - 1]);
+                        }
+                    }
+                };
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (nodes[i].parent.is_null()) visit(i);
+                }
+
+                // Anything left is part of a parent cycle, cut it at the first node found.
+                for (uint32_t i = 0; i < count; ++i) {
+                    if (m_newIndex[i] != NO_PARENT) continue;
+                    logWarning("ECS", "Hierarchy cycle detected at entity {}, detaching it from its parent.",
+                               entities[i].index());
+                    nodes[i].parent = NULL_ENTITY;
+                    visit(i);
+                }
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    nodes[i].parentIndex = nodes[i].parent.is_null()
+                                               ? NO_PARENT
+                                               : m_newIndex[_pool.denseIndex(nodes[i].parent)];
+                }
+
+                _pool.applyOrder(m_order);
+
+                // Pre-order puts children after their parent, so a reverse sweep accumulates subtree sizes.
+                for (uint32_t i = 0; i < count; ++i) {
+                    nodes[i].subtreeSize = 1;
+                    nodes[i].dirty = true;
+                    nodes[i].subtreeDirty = true;
+                }
+                for (uint32_t i = count; i-- > 0;) {
+                    if (nodes[i].parentIndex != NO_PARENT) nodes[nodes[i].parentIndex].subtreeSize += nodes[i].subtreeSize;
+                }
+
+                m_sortedVersion = _pool.version();
+            }
+        };
+    }
+}
@@ -0,0 +1,90 @@
+module;
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hlsl++.h"
+export module opn.ECS:Interpolation;
+import :Registry;
+import :Hierarchy;
+import :tEntity;
+import opn.ECS.Components;
+
+export namespace opn::systems {
+    /**
+     * @brief Keeps the world matrix each entity had after the previous fixed step, so rendering can
+     * blend between the last two steps by Time's interpolation factor.
+     *
+     * update() runs at the end of every fixed step, after the hierarchy, and only touches entities
+     * whose Transform or Hierarchy changed during that step. Anything not moved in the last step
+     * renders its current matrix as is. New and recycled handles start without history and so snap
+     * to their first position.
+     */
+    class TransformInterpolation final {
+        struct sEntry {
+            tEntity entity = NULL_ENTITY;
+            uint32_t step = 0;
+            hlslpp::float4x4 previous = hlslpp::float4x4::identity();
+            hlslpp::float4x4 current = hlslpp::float4x4::identity();
+        };
+
+        Registry *m_registry = nullptr;
+        // Indexed by entity index, entries of dead handles are told apart by the stored handle.
+        std::vector<sEntry> m_entries;
+        uint32_t m_step = 0;
+        uint32_t m_lastTick = 0;
+
+    public:
+        explicit TransformInterpolation(Registry &_registry)
+            : m_registry(&_registry) {}
+
+        void update() {
+            ++m_step;
+
+            const auto *nodes = m_registry->getPool<components::Hierarchy>();
+            m_registry->forEachChanged<components::Transform>(
+                m_lastTick, [&](const tEntity _entity, const components::Transform &_transform) {
+                    const auto *node = nodes->get(_entity);
+                    record(_entity, node ? node->world : _transform.getMatrix());
+                });
+            // Rebuilt nodes are stamped by the hierarchy, which also covers children of moved parents.
+            m_registry->forEachChanged<components::Hierarchy>(
+                m_lastTick, [&](const tEntity _entity, const components::Hierarchy &_node) {
+                    record(_entity, _node.world);
+                });
+            m_lastTick = m_registry->advanceTick();
+        }
+
+        /**
+         * @brief _current blended from the entity's matrix after the step before by _alpha in [0, 1].
+         * Component-wise, which is exact for translation and scale and shrinks a rotation slightly
+         * mid-blend; negligible for the angle a single step turns through.
+         */
+        [[nodiscard]] hlslpp::float4x4 blend(const tEntity _entity, const hlslpp::float4x4 &_current,
+                                             const float _alpha) const {
+            const size_t index = _entity.index();
+            if (_alpha >= 1.0f || index >= m_entries.size()) return _current;
+
+            const auto &entry = m_entries[index];
+            if (entry.entity != _entity || entry.step != m_step) return _current;
+            return entry.previous + (_current - entry.previous) * hlslpp::float1(_alpha);
+        }
+
+        [[nodiscard]] uint32_t lastTick() const noexcept { return m_lastTick; }
+
+    private:
+        void record(const tEntity _entity, const hlslpp::float4x4 &_world) {
+            const size_t index = _entity.index();
+            if (index >= m_entries.size()) m_entries.resize(index + 1);
+
+            auto &entry = m_entries[index];
+            if (entry.entity != _entity) {
+                entry = {.entity = _entity, .step = m_step, .previous = _world, .current = _world};
+                return;
+            }
+            // Seen through both pools this step, the first call already moved current to previous.
+            if (entry.step != m_step) entry.previous = entry.current;
+            entry.step = m_step;
+            entry.current = _world;
+        }
+    };
+}
@@ -1,25 +1,251 @@
 module;
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <memory>
-#include <queue>
-#include <ranges>
-#include <typeindex>
-#include <unordered_map>
+#include <mutex>
+#include <new>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 export module opn.ECS:Registry;
 import :tEntity;
+import opn.Utils.Logging;
 
 export namespace opn {
     class EntityComponentSystem;
+    class Registry;
+    class Snapshot;
+    class World;
 
     namespace systems {
         class Systems;
+        class TransformHierarchy;
+        class TransformInterpolation;
+        class RenderExtraction;
+        class SpatialIndex;
     }
 
+    /**
+     * @brief Opt-in hook for components that are not trivially copyable.
+     *
+     * A component provides a trivially copyable nested sSnapshot plus toSnapshot()/fromSnapshot(),
+     * or specializes SnapshotTraits before its pool is first used. Trivially copyable components
+     * are stored as raw bytes; anything else is left out of snapshots.
+     */
+    template<typename T>
+    concept SnapshotHooks = requires(const T &_component, const typename T::sSnapshot &_stored) {
+        { _component.toSnapshot() } -> std::same_as<typename T::sSnapshot>;
+        { T::fromSnapshot(_stored) } -> std::same_as<T>;
+    };
+
+    template<typename T>
+    struct SnapshotTraits {
+        static constexpr bool enabled = false;
+    };
+
+    /**
+     * @brief Stable name a component is stored under in snapshots, e.g.
+     * static constexpr std::string_view SnapshotName = "opn.Transform";
+     *
+     * Without it the name comes from __PRETTY_FUNCTION__ / __FUNCSIG__, which GCC, Clang and MSVC
+     * spell differently, so those components do not load across compilers.
+     */
+    template<typename T>
+    concept NamedSnapshot = requires {
+        { T::SnapshotName } -> std::convertible_to<std::string_view>;
+    };
+
+    /**
+     * @brief Translates handles of a world merged via Registry::merge() into their new handles.
+     *
+     * Handles that were not alive in the merged world, including ones pointing into the destination,
+     * map to NULL_ENTITY.
+     */
+    class EntityRemap {
+        // Indexed by source entity index: the source handle and the handle it became.
+        std::vector<std::pair<tEntity, tEntity> > m_table;
+
+    public:
+        EntityRemap() = default;
+
+        explicit EntityRemap(const size_t _sourceIndices)
+            : m_table(_sourceIndices, {NULL_ENTITY, NULL_ENTITY}) {}
+
+        void set(const tEntity _from, const tEntity _to) { m_table[_from.index()] = {_from, _to}; }
+
+        [[nodiscard]] tEntity operator()(const tEntity _entity) const noexcept {
+            if (_entity.is_null() || _entity.index() >= m_table.size()) return NULL_ENTITY;
+
+            const auto &[from, to] = m_table[_entity.index()];
+            return from == _entity ? to : NULL_ENTITY;
+        }
+    };
+
+    /**
+     * @brief Opt-in hook for components holding entity handles, called when their world is merged
+     * into another so the handles can be rewritten, e.g. parent = _remap(parent).
+     */
+    template<typename T>
+    concept EntityRemapHooks = requires(T &_component, const EntityRemap &_remap) {
+        _component.remapEntities(_remap);
+    };
+
+    template<SnapshotHooks T>
+    struct SnapshotTraits<T> {
+        static constexpr bool enabled = true;
+        using Stored = typename T::sSnapshot;
+
+        static Stored save(const T &_component) { return _component.toSnapshot(); }
+        static T load(const Stored &_stored) { return T::fromSnapshot(_stored); }
+    };
+
+    template<typename T> requires (std::is_trivially_copyable_v<T> && !SnapshotHooks<T>)
+    struct SnapshotTraits<T> {
+        static constexpr bool enabled = true;
+        using Stored = T;
+
+        static const T &save(const T &_component) { return _component; }
+        static const T &load(const T &_stored) { return _stored; }
+    };
+
     namespace detail {
+        inline uint32_t nextComponentTypeId() noexcept {
+            static std::atomic<uint32_t> s_counter{0};
+            return s_counter.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Small dense per-process id for a component type, assigned on first use.
+         */
+        template<typename T>
+        uint32_t componentTypeId() noexcept {
+            static const uint32_t s_id = nextComponentTypeId();
+            return s_id;
+        }
+
+        /**
+         * @brief Readable component type name, used for memory reports.
+         */
+        template<typename T>
+        constexpr std::string_view componentTypeName() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+            constexpr std::string_view signature = __FUNCSIG__;
+            constexpr auto first = signature.find("componentTypeName<") + 18;
+            constexpr auto last = signature.rfind(">(void)");
+            std::string_view name = signature.substr(first, last - first);
+            for (const std::string_view prefix: {"struct ", "class ", "enum "}) {
+                if (name.starts_with(prefix)) name.remove_prefix(prefix.size());
+            }
+            return name;
+#else
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr auto first = signature.find("T = ") + 4;
+            constexpr auto last = signature.find_first_of(";]", first);
+            return signature.substr(first, last - first);
+#endif
+        }
+
+        /**
+         * @brief FNV-1a of the SnapshotName, or of the type name, the id of a component type inside snapshots.
+         */
+        template<typename T>
+        constexpr uint64_t componentTypeHash() noexcept {
+            std::string_view name;
+            if constexpr (NamedSnapshot<T>) name = T::SnapshotName;
+            else name = componentTypeName<T>();
+
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (const char c: name) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Per-registry pool of fixed-size blocks backing the pools' sparse pages.
+         *
+         * Released blocks go to a free list for reuse and are only handed back to the OS by trim(),
+         * so steady-state churn never reaches the global allocator. Not thread safe; the registry
+         * is only mutated from the ECS update and command buffer playback.
+         */
+        class BlockArena {
+        public:
+            static constexpr size_t BLOCK_SIZE = 16 * 1024;
+            static constexpr size_t BLOCK_ALIGN = 64;
+
+        private:
+            std::vector<void *> m_free;
+            size_t m_blockCount = 0;
+
+        public:
+            BlockArena() = default;
+
+            BlockArena(const BlockArena &) = delete;
+
+            BlockArena &operator=(const BlockArena &) = delete;
+
+            ~BlockArena() { trim(0); }
+
+            [[nodiscard]] void *allocate() {
+                if (!m_free.empty()) {
+                    void *block = m_free.back();
+                    m_free.pop_back();
+                    return block;
+                }
+
+                ++m_blockCount;
+                return ::operator new(BLOCK_SIZE, std::align_val_t{BLOCK_ALIGN});
+            }
+
+            void release(void *_block) {
+                m_free.push_back(_block);
+            }
+
+            /**
+             * @brief Returns cached free blocks to the OS, keeping at most _keep for reuse.
+             */
+            void trim(const size_t _keep) {
+                while (m_free.size() > _keep) {
+                    ::operator delete(m_free.back(), std::align_val_t{BLOCK_ALIGN});
+                    m_free.pop_back();
+                    --m_blockCount;
+                }
+                m_free.shrink_to_fit();
+            }
+
+            [[nodiscard]] size_t reservedBytes() const noexcept { return m_blockCount * BLOCK_SIZE; }
+            [[nodiscard]] size_t usedBytes() const noexcept { return (m_blockCount - m_free.size()) * BLOCK_SIZE; }
+        };
+
+        struct sPoolMemoryStats {
+            std::string_view name;
+            size_t count = 0;
+            size_t denseBytes = 0;     // live elements across the dense arrays
+            size_t reservedBytes = 0;  // dense capacity, including denseBytes
+            size_t sparseBytes = 0;    // arena pages plus the page table
+            size_t logBytes = 0;       // change and removal logs
+        };
+
+        /**
+         * @brief One entry of a pool's change or removal log, appended in tick order.
+         */
+        struct sChangeEntry {
+            tEntity entity;
+            uint32_t tick;
+        };
+
         class iComponentPool {
         public:
             virtual ~iComponentPool() = default;
@@ -27,67 +253,625 @@ export namespace opn {
             virtual void remove(tEntity _entity) = 0;
 
             [[nodiscard]] virtual bool has(tEntity _entity) const = 0;
+
+            /**
+             * @brief Drops log entries no consumer can still ask for, i.e. ticks <= _oldestTick.
+             */
+            virtual void trimChangeLogs(uint32_t _oldestTick) = 0;
+
+            /**
+             * @brief Releases spare dense capacity and empty sparse pages.
+             */
+            virtual void shrinkToFit() = 0;
+
+            /**
+             * @brief True when shrinkToFit() would free a worthwhile amount of memory.
+             */
+            [[nodiscard]] virtual bool wantsCompaction() const = 0;
+
+            [[nodiscard]] virtual sPoolMemoryStats memoryStats() const = 0;
+
+            [[nodiscard]] virtual size_t size() const = 0;
+
+            [[nodiscard]] virtual uint64_t typeHash() const = 0;
+
+            [[nodiscard]] virtual bool snapshotEnabled() const = 0;
+
+            /**
+             * @brief Bytes per component in a snapshot; 0 for tags, which only store entities.
+             */
+            [[nodiscard]] virtual size_t snapshotStride() const = 0;
+
+            virtual void writeSnapshot(std::byte *_components, tEntity *_entities) const = 0;
+
+            /**
+             * @brief Replaces the pool contents with _count components read from a snapshot.
+             *
+             * Dense arrays are bulk copied and the sparse pages rebuilt from the entity list; every
+             * restored component counts as added in the current tick.
+             */
+            virtual void readSnapshot(const std::byte *_components, const tEntity *_entities, size_t _count) = 0;
+
+            virtual void clear() = 0;
+
+            /**
+             * @brief Empty pool of the same type for another registry, used when merging worlds.
+             */
+            [[nodiscard]] virtual std::unique_ptr<iComponentPool> makeEmpty(
+                const uint32_t *_tick, BlockArena *_arena,
+                const std::vector<tEntity::generation_type> *_generations) const = 0;
+
+            /**
+             * @brief Moves every component into _target, a pool of the same type in another registry,
+             * renaming the entities through _remap. Leaves this pool empty.
+             */
+            virtual void mergeInto(iComponentPool &_target, const EntityRemap &_remap) = 0;
+
+            /**
+             * @brief Dense slot of _entity, 0xFFFFFFFF if absent. Used by owning groups.
+             */
+            [[nodiscard]] virtual uint32_t denseSlot(tEntity _entity) const = 0;
+
+            [[nodiscard]] virtual tEntity denseEntity(uint32_t _slot) const = 0;
+
+            /**
+             * @brief Exchanges two dense slots and fixes the sparse entries, change ticks move along.
+             */
+            virtual void swapDense(uint32_t _a, uint32_t _b) = 0;
+        };
+
+        /**
+         * @brief Keeps the dense arrays of two or more pools sorted so their first size() slots hold
+         * the same entities, in the same order.
+         *
+         * Owned pools call back here whenever an entity is inserted or removed: a new entity that
+         * completes the set is swapped to slot size() in every pool, a removed one is swapped out of
+         * the packed range before the pool erases it. Iterating the owned types is then a lock-step
+         * walk over [0, size()) with no sparse lookups.
+         */
+        class OwningGroup {
+            std::vector<iComponentPool *> m_pools;
+            uint32_t m_size = 0;
+
+            [[nodiscard]] bool containsAll(const tEntity _entity) const {
+                return std::ranges::all_of(m_pools, [_entity](const auto *_pool) { return _pool->has(_entity); });
+            }
+
+            void moveTo(const tEntity _entity, const uint32_t _slot) {
+                for (auto *pool: m_pools) {
+                    if (const uint32_t from = pool->denseSlot(_entity); from != _slot) pool->swapDense(from, _slot);
+                }
+            }
+
+        public:
+            explicit OwningGroup(std::vector<iComponentPool *> _pools)
+                : m_pools(std::move(_pools)) {}
+
+            [[nodiscard]] uint32_t size() const noexcept { return m_size; }
+            [[nodiscard]] size_t poolCount() const noexcept { return m_pools.size(); }
+
+            [[nodiscard]] bool owns(const iComponentPool *_pool) const {
+                return std::ranges::find(m_pools, _pool) != m_pools.end();
+            }
+
+            void onInsert(const tEntity _entity) {
+                if (m_pools.front()->denseSlot(_entity) < m_size || !containsAll(_entity)) return;
+                moveTo(_entity, m_size++);
+            }
+
+            void onRemove(const tEntity _entity) {
+                const uint32_t slot = m_pools.front()->denseSlot(_entity);
+                if (slot >= m_size || !containsAll(_entity)) return;
+                moveTo(_entity, --m_size);
+            }
+
+            /**
+             * @brief Re-packs the group from scratch, after bulk edits such as a snapshot restore.
+             */
+            void rebuild() {
+                m_size = 0;
+                auto *lead = m_pools.front();
+                for (uint32_t i = 0; i < lead->size(); ++i) {
+                    const tEntity entity = lead->denseEntity(i);
+                    if (containsAll(entity)) moveTo(entity, m_size++);
+                }
+            }
         };
 
         template<typename T>
         class ComponentPool : public iComponentPool {
-            friend class Registry;
+            friend class opn::Registry;
+
+            static constexpr uint32_t NONE = 0xFFFFFFFF;
+            static constexpr uint32_t PAGE_SHIFT = 12;
+            static constexpr uint32_t PAGE_ENTRIES = 1u << PAGE_SHIFT;
+            static constexpr uint32_t PAGE_MASK = PAGE_ENTRIES - 1;
+            static_assert(PAGE_ENTRIES * sizeof(uint32_t) == BlockArena::BLOCK_SIZE);
+
+            // Paged sparse array: entity index -> dense slot. Pages come from the registry's arena and
+            // go back to it once their last entity is removed.
+            BlockArena *m_arena = nullptr;
+            std::vector<uint32_t *> m_pages;
+            std::vector<uint16_t> m_pageCounts;
 
-            std::vector<uint32_t> m_sparse;
             std::vector<T> m_components;
             std::vector<tEntity> m_entities;
 
+            // Bumped on every insert and remove so systems caching a derived layout can detect edits.
+            uint64_t m_version = 0;
+
+            // Set while this pool is owned by a group, which then dictates the dense order.
+            OwningGroup *m_group = nullptr;
+
+            // Change tracking, parallel to the dense arrays. Ticks come from the owning Registry.
+            const uint32_t *m_tick = nullptr;
+            std::vector<uint32_t> m_addedTicks;
+            std::vector<uint32_t> m_changedTicks;
+
+            // Entries are only appended the first time a slot changes in a given tick; queries since a
+            // tick older than m_logFloor fall back to scanning m_changedTicks.
+            std::vector<sChangeEntry> m_changeLog;
+            std::vector<sChangeEntry> m_removeLog;
+            uint32_t m_logFloor = 0;
+
+            [[nodiscard]] uint32_t sparseAt(const uint32_t _id) const noexcept {
+                const uint32_t page = _id >> PAGE_SHIFT;
+                if (page >= m_pages.size() || !m_pages[page]) return NONE;
+                return m_pages[page][_id & PAGE_MASK];
+            }
+
+            void sparseSet(const uint32_t _id, const uint32_t _slot) {
+                const uint32_t page = _id >> PAGE_SHIFT;
+                if (page >= m_pages.size()) {
+                    m_pages.resize(page + 1, nullptr);
+                    m_pageCounts.resize(page + 1, 0);
+                }
+
+                if (!m_pages[page]) {
+                    m_pages[page] = static_cast<uint32_t *>(m_arena->allocate());
+                    std::fill_n(m_pages[page], PAGE_ENTRIES, NONE);
+                }
+
+                uint32_t &entry = m_pages[page][_id & PAGE_MASK];
+                if (entry == NONE) ++m_pageCounts[page];
+                entry = _slot;
+            }
+
+            void sparseClear(const uint32_t _id) {
+                const uint32_t page = _id >> PAGE_SHIFT;
+                m_pages[page][_id & PAGE_MASK] = NONE;
+
+                if (--m_pageCounts[page] == 0) {
+                    m_arena->release(m_pages[page]);
+                    m_pages[page] = nullptr;
+                }
+            }
+
+            static size_t bytes(const auto &_vector) noexcept {
+                return _vector.size() * sizeof(_vector[0]);
+            }
+
+            static size_t capacityBytes(const auto &_vector) noexcept {
+                return _vector.capacity() * sizeof(_vector[0]);
+            }
+
         public:
+            ComponentPool(const uint32_t *_tick, BlockArena *_arena)
+                : m_arena(_arena), m_tick(_tick) {}
+
+            ComponentPool(const ComponentPool &) = delete;
+
+            ComponentPool &operator=(const ComponentPool &) = delete;
+
+            ~ComponentPool() override {
+                for (auto *page: m_pages) {
+                    if (page) m_arena->release(page);
+                }
+            }
+
+            /**
+             * @brief Adds or overwrites _entity's component.
+             * @note _entity must be alive. A different handle found at its index is a dead entity's
+             * leftover and is removed first, so it never overwrites the new owner's slot.
+             */
             void insert(tEntity _entity, T _component) {
                 uint32_t id = _entity.index();
+                ++m_version;
 
-                if (id >= m_sparse.size()) m_sparse.resize(id + 1, 0xFFFFFFFF);
-
-                if (m_sparse[id] != 0xFFFFFFFF) {
-                    m_components[m_sparse[id]] = std::move(_component);
-                    return;
+                if (const uint32_t slot = sparseAt(id); slot != NONE) {
+                    if (m_entities[slot] == _entity) {
+                        m_components[slot] = std::move(_component);
+                        markChangedAt(slot);
+                        return;
+                    }
+                    remove(m_entities[slot]);
                 }
 
-                m_sparse[id] = static_cast<uint32_t>(m_entities.size());
+                sparseSet(id, static_cast<uint32_t>(m_entities.size()));
                 m_entities.push_back(_entity);
                 m_components.push_back(std::move(_component));
+                m_addedTicks.push_back(*m_tick);
+                m_changedTicks.push_back(*m_tick);
+                m_changeLog.push_back({_entity, *m_tick});
+
+                if (m_group) m_group->onInsert(_entity);
             }
 
             void remove(tEntity _entity) override {
                 uint32_t id = _entity.index();
-                if (id >= m_sparse.size() || m_sparse[id] == 0xFFFFFFF) return;
+                if (denseIndex(_entity) == NONE) return;
+                ++m_version;
+
+                if (m_group) m_group->onRemove(_entity);
+                const uint32_t indexToRemove = sparseAt(id);
 
-                uint32_t indexToRemove = m_sparse[id];
                 uint32_t lastIndex = static_cast<uint32_t>(m_entities.size() - 1);
                 tEntity lastEntity = m_entities[lastIndex];
 
                 if (indexToRemove != lastIndex) {
                     m_components[indexToRemove] = std::move(m_components[lastIndex]);
                     m_entities[indexToRemove] = m_entities[lastIndex];
+                    m_addedTicks[indexToRemove] = m_addedTicks[lastIndex];
+                    m_changedTicks[indexToRemove] = m_changedTicks[lastIndex];
 
-                    m_sparse[lastEntity.index()] = indexToRemove;
+                    sparseSet(lastEntity.index(), indexToRemove);
                 }
 
                 m_components.pop_back();
                 m_entities.pop_back();
-                m_sparse[id] = 0xFFFFFFFF;
+                m_addedTicks.pop_back();
+                m_changedTicks.pop_back();
+                sparseClear(id);
+                m_removeLog.push_back({_entity, *m_tick});
             }
 
+            void reserve(const size_t _capacity) {
+                m_components.reserve(_capacity);
+                m_entities.reserve(_capacity);
+                m_addedTicks.reserve(_capacity);
+                m_changedTicks.reserve(_capacity);
+            }
+
+            /**
+             * @brief Stamps the component in dense slot _index as modified in the current tick.
+             */
+            void markChangedAt(const uint32_t _index) {
+                if (m_changedTicks[_index] == *m_tick) return;
+                m_changedTicks[_index] = *m_tick;
+                m_changeLog.push_back({m_entities[_index], *m_tick});
+            }
+
+            void markChanged(const tEntity _entity) {
+                if (const uint32_t index = denseIndex(_entity); index != NONE) markChangedAt(index);
+            }
+
+            /**
+             * @brief Calls _func(entity, const T&) for components modified (or added) after _since.
+             *
+             * Walks only the log suffix newer than _since. An entity appears once, on its latest
+             * entry, even if it changed in several ticks.
+             */
+            template<typename Func>
+            void forEachChanged(const uint32_t _since, Func &&_func) const {
+                if (_since < m_logFloor) {
+                    for (size_t i = 0; i < m_entities.size(); ++i) {
+                        if (m_changedTicks[i] > _since) _func(m_entities[i], m_components[i]);
+                    }
+                    return;
+                }
+
+                const auto first = std::partition_point(m_changeLog.begin(), m_changeLog.end(),
+                                                        [_since](const sChangeEntry &_entry) {
+                                                            return _entry.tick <= _since;
+                                                        });
+                for (auto it = first; it != m_changeLog.end(); ++it) {
+                    const uint32_t index = denseIndex(it->entity);
+                    if (index == NONE || m_entities[index] != it->entity) continue;
+                    if (m_changedTicks[index] != it->tick) continue;
+                    _func(it->entity, m_components[index]);
+                }
+            }
+
+            template<typename Func>
+            void forEachAdded(const uint32_t _since, Func &&_func) const {
+                forEachChanged(_since, [&](const tEntity _entity, const T &_component) {
+                    if (m_addedTicks[sparseAt(_entity.index())] > _since) _func(_entity, _component);
+                });
+            }
+
+            /**
+             * @brief Calls _func(entity) for every removal after _since, including removals of entities
+             * that have since had the component added back.
+             */
+            template<typename Func>
+            void forEachRemoved(const uint32_t _since, Func &&_func) const {
+                const auto first = std::partition_point(m_removeLog.begin(), m_removeLog.end(),
+                                                        [_since](const sChangeEntry &_entry) {
+                                                            return _entry.tick <= _since;
+                                                        });
+                for (auto it = first; it != m_removeLog.end(); ++it) {
+                    _func(it->entity);
+                }
+            }
+
+            void trimChangeLogs(const uint32_t _oldestTick) override {
+                const auto trim = [_oldestTick](std::vector<sChangeEntry> &_log) {
+                    const auto keep = std::partition_point(_log.begin(), _log.end(),
+                                                           [_oldestTick](const sChangeEntry &_entry) {
+                                                               return _entry.tick <= _oldestTick;
+                                                           });
+                    _log.erase(_log.begin(), keep);
+                };
+
+                trim(m_changeLog);
+                trim(m_removeLog);
+                m_logFloor = std::max(m_logFloor, _oldestTick);
+            }
+
+            /**
+             * @brief Inserts one component per entity, sizing every array once up front.
+             */
+            void insertBatch(const std::span<const tEntity> _entities, T *_components) {
+                uint32_t maxIndex = 0;
+                for (const auto entity: _entities) maxIndex = std::max(maxIndex, entity.index());
+
+                const uint32_t pageCount = (maxIndex >> PAGE_SHIFT) + 1;
+                if (pageCount > m_pages.size()) {
+                    m_pages.resize(pageCount, nullptr);
+                    m_pageCounts.resize(pageCount, 0);
+                }
+                reserve(m_entities.size() + _entities.size());
+
+                for (size_t i = 0; i < _entities.size(); ++i) {
+                    insert(_entities[i], std::move(_components[i]));
+                }
+            }
+
+            /**
+             * @brief Reorders the dense arrays so slot i holds what was at _order[i].
+             * @note _order must be a permutation of [0, size()); the version is left untouched.
+             */
+            void applyOrder(const std::span<const uint32_t> _order) {
+                std::vector<T> components;
+                std::vector<tEntity> entities;
+                std::vector<uint32_t> addedTicks;
+                std::vector<uint32_t> changedTicks;
+                components.reserve(_order.size());
+                entities.reserve(_order.size());
+                addedTicks.reserve(_order.size());
+                changedTicks.reserve(_order.size());
+
+                for (const uint32_t from: _order) {
+                    components.push_back(std::move(m_components[from]));
+                    entities.push_back(m_entities[from]);
+                    addedTicks.push_back(m_addedTicks[from]);
+                    changedTicks.push_back(m_changedTicks[from]);
+                }
+
+                m_components = std::move(components);
+                m_entities = std::move(entities);
+                m_addedTicks = std::move(addedTicks);
+                m_changedTicks = std::move(changedTicks);
+                for (uint32_t i = 0; i < m_entities.size(); ++i) {
+                    sparseSet(m_entities[i].index(), i);
+                }
+                if (m_group) m_group->rebuild();
+            }
+
+            [[nodiscard]] const OwningGroup *owningGroup() const noexcept { return m_group; }
+
+            [[nodiscard]] uint32_t denseSlot(const tEntity _entity) const override { return denseIndex(_entity); }
+
+            [[nodiscard]] tEntity denseEntity(const uint32_t _slot) const override { return m_entities[_slot]; }
+
+            void swapDense(const uint32_t _a, const uint32_t _b) override {
+                using std::swap;
+                swap(m_components[_a], m_components[_b]);
+                swap(m_entities[_a], m_entities[_b]);
+                swap(m_addedTicks[_a], m_addedTicks[_b]);
+                swap(m_changedTicks[_a], m_changedTicks[_b]);
+                sparseSet(m_entities[_a].index(), _a);
+                sparseSet(m_entities[_b].index(), _b);
+            }
+
+            /**
+             * @brief Dense slot of _entity, NONE if absent. The stored handle is compared as well, so a
+             * stale handle whose index has been recycled does not resolve to the new owner.
+             */
+            [[nodiscard]] uint32_t denseIndex(const tEntity _entity) const noexcept {
+                const uint32_t slot = sparseAt(_entity.index());
+                return slot != NONE && m_entities[slot] == _entity ? slot : NONE;
+            }
+
+            [[nodiscard]] uint64_t version() const noexcept { return m_version; }
+            [[nodiscard]] size_t size() const noexcept override { return m_entities.size(); }
+
+            // Tick of the last write per dense slot, for caches that mirror the dense array.
+            [[nodiscard]] std::span<const uint32_t> changedTicks() const noexcept { return m_changedTicks; }
+
             T *get(const tEntity _entity) {
-                const uint32_t id = _entity.index();
-                if (id >= m_sparse.size() || m_sparse[id] == 0xFFFFFFFF) return nullptr;
-                return &m_components[m_sparse[id]];
+                const uint32_t slot = denseIndex(_entity);
+                return slot == NONE ? nullptr : &m_components[slot];
             }
 
             const T *get(const tEntity _entity) const {
-                const uint32_t id = _entity.index();
-                if (id >= m_sparse.size() || m_sparse[id] == 0xFFFFFFFF) return nullptr;
-                return &m_components[m_sparse[id]];
+                const uint32_t slot = denseIndex(_entity);
+                return slot == NONE ? nullptr : &m_components[slot];
             }
 
             [[nodiscard]] bool has(tEntity _entity) const override {
-                const uint32_t id = _entity.index();
-                return id < m_sparse.size() && m_sparse[id] != 0xFFFFFFFF;
+                return denseIndex(_entity) != NONE;
+            }
+
+            void shrinkToFit() override {
+                m_components.shrink_to_fit();
+                m_entities.shrink_to_fit();
+                m_addedTicks.shrink_to_fit();
+                m_changedTicks.shrink_to_fit();
+                m_changeLog.shrink_to_fit();
+                m_removeLog.shrink_to_fit();
+
+                while (!m_pages.empty() && !m_pages.back()) {
+                    m_pages.pop_back();
+                    m_pageCounts.pop_back();
+                }
+                m_pages.shrink_to_fit();
+                m_pageCounts.shrink_to_fit();
+            }
+
+            [[nodiscard]] bool wantsCompaction() const override {
+                // Only bother once at least half the dense capacity is spare and it is worth a block.
+                const size_t spare = (m_components.capacity() - m_components.size()) * sizeof(T);
+                return spare >= BlockArena::BLOCK_SIZE && m_components.capacity() >= 2 * m_components.size();
+            }
+
+            [[nodiscard]] uint64_t typeHash() const override { return componentTypeHash<T>(); }
+
+            [[nodiscard]] bool snapshotEnabled() const override { return SnapshotTraits<T>::enabled; }
+
+            [[nodiscard]] size_t snapshotStride() const override {
+                if constexpr (SnapshotTraits<T>::enabled) return sizeof(typename SnapshotTraits<T>::Stored);
+                else return 0;
+            }
+
+            void writeSnapshot(std::byte *_components, tEntity *_entities) const override {
+                if constexpr (SnapshotTraits<T>::enabled) {
+                    if (m_entities.empty()) return;
+                    using Traits = SnapshotTraits<T>;
+                    using Stored = typename Traits::Stored;
+                    static_assert(std::is_trivially_copyable_v<Stored>, "Snapshot storage must be trivially copyable");
+
+                    if constexpr (std::is_same_v<Stored, T>) {
+                        std::memcpy(_components, m_components.data(), m_components.size() * sizeof(T));
+                    } else {
+                        for (size_t i = 0; i < m_components.size(); ++i) {
+                            const Stored stored = Traits::save(m_components[i]);
+                            std::memcpy(_components + i * sizeof(Stored), &stored, sizeof(Stored));
+                        }
+                    }
+                    std::memcpy(_entities, m_entities.data(), m_entities.size() * sizeof(tEntity));
+                }
+            }
+
+            void readSnapshot(const std::byte *_components, const tEntity *_entities, const size_t _count) override {
+                if constexpr (SnapshotTraits<T>::enabled) {
+                    using Traits = SnapshotTraits<T>;
+                    using Stored = typename Traits::Stored;
+
+                    clear();
+                    if constexpr (std::is_same_v<Stored, T>) {
+                        const auto *first = reinterpret_cast<const T *>(_components);
+                        m_components.assign(first, first + _count);
+                    } else {
+                        m_components.reserve(_count);
+                        for (size_t i = 0; i < _count; ++i) {
+                            Stored stored;
+                            std::memcpy(&stored, _components + i * sizeof(Stored), sizeof(Stored));
+                            m_components.push_back(Traits::load(stored));
+                        }
+                    }
+
+                    m_entities.assign(_entities, _entities + _count);
+                    m_addedTicks.assign(_count, *m_tick);
+                    m_changedTicks.assign(_count, *m_tick);
+                    for (uint32_t i = 0; i < _count; ++i) {
+                        sparseSet(m_entities[i].index(), i);
+                    }
+                    if (m_group) m_group->rebuild();
+                }
+            }
+
+            /**
+             * @brief Drops every component without logging removals; change queries older than now
+             * fall back to a full scan afterwards.
+             */
+            void clear() override {
+                ++m_version;
+                for (auto *page: m_pages) {
+                    if (page) m_arena->release(page);
+                }
+                m_pages.clear();
+                m_pageCounts.clear();
+
+                m_components.clear();
+                m_entities.clear();
+                m_addedTicks.clear();
+                m_changedTicks.clear();
+                m_changeLog.clear();
+                m_removeLog.clear();
+                m_logFloor = *m_tick;
+                if (m_group) m_group->rebuild();
+            }
+
+            [[nodiscard]] std::unique_ptr<iComponentPool> makeEmpty(
+                const uint32_t *_tick, BlockArena *_arena,
+                const std::vector<tEntity::generation_type> *) const override {
+                return std::make_unique<ComponentPool>(_tick, _arena);
+            }
+
+            /**
+             * An empty target takes the dense arrays over as they are, otherwise they are appended in
+             * one go. Either way the sparse pages are rebuilt and every component counts as added.
+             */
+            void mergeInto(iComponentPool &_target, const EntityRemap &_remap) override {
+                auto &target = static_cast<ComponentPool &>(_target);
+                if (m_entities.empty()) return;
+
+                if constexpr (EntityRemapHooks<T>) {
+                    for (auto &component: m_components) component.remapEntities(_remap);
+                }
+
+                uint32_t maxIndex = 0;
+                for (auto &entity: m_entities) {
+                    entity = _remap(entity);
+                    maxIndex = std::max(maxIndex, entity.index());
+                }
+
+                const auto first = static_cast<uint32_t>(target.m_entities.size());
+                if (first == 0) {
+                    target.m_components = std::move(m_components);
+                    target.m_entities = std::move(m_entities);
+                } else {
+                    target.reserve(first + m_entities.size());
+                    target.m_components.insert(target.m_components.end(), std::make_move_iterator(m_components.begin()),
+                                               std::make_move_iterator(m_components.end()));
+                    target.m_entities.insert(target.m_entities.end(), m_entities.begin(), m_entities.end());
+                }
+
+                const auto count = static_cast<uint32_t>(target.m_entities.size());
+                const uint32_t tick = *target.m_tick;
+                target.m_addedTicks.resize(count, tick);
+                target.m_changedTicks.resize(count, tick);
+
+                const uint32_t pageCount = (maxIndex >> PAGE_SHIFT) + 1;
+                if (pageCount > target.m_pages.size()) {
+                    target.m_pages.resize(pageCount, nullptr);
+                    target.m_pageCounts.resize(pageCount, 0);
+                }
+                target.m_changeLog.reserve(target.m_changeLog.size() + (count - first));
+                for (uint32_t i = first; i < count; ++i) {
+                    target.sparseSet(target.m_entities[i].index(), i);
+                    target.m_changeLog.push_back({target.m_entities[i], tick});
+                }
+
+                ++target.m_version;
+                if (target.m_group) target.m_group->rebuild();
+                clear();
+            }
+
+            [[nodiscard]] sPoolMemoryStats memoryStats() const override {
+                size_t pages = 0;
+                for (const auto *page: m_pages) pages += page != nullptr;
+
+                return {
+                    .name = componentTypeName<T>(),
+                    .count = m_entities.size(),
+                    .denseBytes = bytes(m_components) + bytes(m_entities) + bytes(m_addedTicks) + bytes(m_changedTicks),
+                    .reservedBytes = capacityBytes(m_components) + capacityBytes(m_entities) +
+                                     capacityBytes(m_addedTicks) + capacityBytes(m_changedTicks),
+                    .sparseBytes = pages * BlockArena::BLOCK_SIZE + capacityBytes(m_pages) + capacityBytes(m_pageCounts),
+                    .logBytes = capacityBytes(m_changeLog) + capacityBytes(m_removeLog)
+                };
             }
 
             auto &components() { return m_components; }
@@ -95,59 +879,476 @@ export namespace opn {
             const auto &components() const { return m_components; }
             const auto &entities() const { return m_entities; }
         };
+
+        /**
+         * @brief Storage for empty (tag) components: one bit per entity index, no dense arrays.
+         *
+         * Mirrors the ComponentPool surface used by the registry and command buffer. Handles are
+         * rebuilt from the registry's generations while iterating. Tags carry no data, so they are
+         * not change tracked.
+         */
+        template<typename T>
+        class TagPool : public iComponentPool {
+            static_assert(std::is_empty_v<T>);
+
+            const std::vector<tEntity::generation_type> *m_generations = nullptr;
+            std::vector<uint64_t> m_words;
+            size_t m_count = 0;
+            uint64_t m_version = 0;
+
+            inline static T s_instance{};
+
+            // The bit only says the index is tagged; the handle must also be the index's current owner.
+            [[nodiscard]] bool isCurrent(const tEntity _entity) const noexcept {
+                const uint32_t id = _entity.index();
+                return id < m_generations->size() && (*m_generations)[id] == _entity.generation();
+            }
+
+        public:
+            explicit TagPool(const std::vector<tEntity::generation_type> *_generations)
+                : m_generations(_generations) {}
+
+            void insert(const tEntity _entity, T = {}) {
+                if (!isCurrent(_entity)) return;
+
+                const uint32_t id = _entity.index();
+                if (id / 64 >= m_words.size()) m_words.resize(id / 64 + 1, 0);
+
+                uint64_t &word = m_words[id / 64];
+                const uint64_t bit = uint64_t{1} << (id % 64);
+                if (word & bit) return;
+
+                word |= bit;
+                ++m_count;
+                ++m_version;
+            }
+
+            void insertBatch(const std::span<const tEntity> _entities, T *) {
+                uint32_t maxIndex = 0;
+                for (const auto entity: _entities) maxIndex = std::max(maxIndex, entity.index());
+                if (maxIndex / 64 >= m_words.size()) m_words.resize(maxIndex / 64 + 1, 0);
+
+                for (const auto entity: _entities) insert(entity);
+            }
+
+            void reserve(size_t) {}
+
+            void remove(const tEntity _entity) override {
+                const uint32_t id = _entity.index();
+                if (id / 64 >= m_words.size() || !isCurrent(_entity)) return;
+
+                uint64_t &word = m_words[id / 64];
+                const uint64_t bit = uint64_t{1} << (id % 64);
+                if (!(word & bit)) return;
+
+                word &= ~bit;
+                --m_count;
+                ++m_version;
+            }
+
+            [[nodiscard]] bool has(const tEntity _entity) const override {
+                const uint32_t id = _entity.index();
+                return id / 64 < m_words.size() && (m_words[id / 64] >> (id % 64) & 1) && isCurrent(_entity);
+            }
+
+            T *get(const tEntity _entity) { return has(_entity) ? &s_instance : nullptr; }
+            const T *get(const tEntity _entity) const { return has(_entity) ? &s_instance : nullptr; }
+
+            static T &instance() noexcept { return s_instance; }
+
+            [[nodiscard]] std::span<const uint64_t> words() const noexcept { return m_words; }
+
+            [[nodiscard]] tEntity entityAt(const uint32_t _index) const noexcept {
+                return tEntity::make(_index, (*m_generations)[_index]);
+            }
+
+            template<typename Func>
+            void each(Func &&_func) const {
+                for (size_t w = 0; w < m_words.size(); ++w) {
+                    for (uint64_t bits = m_words[w]; bits; bits &= bits - 1) {
+                        _func(entityAt(static_cast<uint32_t>(w * 64 + std::countr_zero(bits))));
+                    }
+                }
+            }
+
+            [[nodiscard]] uint64_t version() const noexcept { return m_version; }
+            [[nodiscard]] size_t size() const noexcept override { return m_count; }
+
+            void trimChangeLogs(uint32_t) override {}
+
+            void shrinkToFit() override {
+                while (!m_words.empty() && m_words.back() == 0) m_words.pop_back();
+                m_words.shrink_to_fit();
+            }
+
+            [[nodiscard]] bool wantsCompaction() const override {
+                return (m_words.capacity() - m_words.size()) * sizeof(uint64_t) >= BlockArena::BLOCK_SIZE;
+            }
+
+            [[nodiscard]] sPoolMemoryStats memoryStats() const override {
+                return {
+                    .name = componentTypeName<T>(),
+                    .count = m_count,
+                    .sparseBytes = m_words.capacity() * sizeof(uint64_t)
+                };
+            }
+
+            [[nodiscard]] uint64_t typeHash() const override { return componentTypeHash<T>(); }
+            [[nodiscard]] bool snapshotEnabled() const override { return true; }
+            [[nodiscard]] size_t snapshotStride() const override { return 0; }
+
+            void writeSnapshot(std::byte *, tEntity *_entities) const override {
+                each([&](const tEntity _entity) { *_entities++ = _entity; });
+            }
+
+            void readSnapshot(const std::byte *, const tEntity *_entities, const size_t _count) override {
+                clear();
+                insertBatch({_entities, _count}, nullptr);
+            }
+
+            void clear() override {
+                m_words.clear();
+                m_count = 0;
+                ++m_version;
+            }
+
+            [[nodiscard]] std::unique_ptr<iComponentPool> makeEmpty(
+                const uint32_t *, BlockArena *,
+                const std::vector<tEntity::generation_type> *_generations) const override {
+                return std::make_unique<TagPool>(_generations);
+            }
+
+            void mergeInto(iComponentPool &_target, const EntityRemap &_remap) override {
+                auto &target = static_cast<TagPool &>(_target);
+                each([&](const tEntity _entity) { target.insert(_remap(_entity)); });
+                clear();
+            }
+
+            // Tags have no dense order, a slot is simply the entity index.
+            [[nodiscard]] uint32_t denseSlot(const tEntity _entity) const override {
+                return has(_entity) ? _entity.index() : 0xFFFFFFFF;
+            }
+
+            [[nodiscard]] tEntity denseEntity(const uint32_t _slot) const override { return entityAt(_slot); }
+
+            void swapDense(uint32_t, uint32_t) override {}
+        };
+
+        template<typename T>
+        using PoolFor = std::conditional_t<std::is_empty_v<T>, TagPool<T>, ComponentPool<T> >;
+
+        class iSingleton {
+        public:
+            virtual ~iSingleton() = default;
+        };
+
+        template<typename T>
+        class Singleton final : public iSingleton {
+        public:
+            T value;
+
+            template<typename... Args>
+            explicit Singleton(Args &&... _args)
+                : value(std::forward<Args>(_args)...) {}
+        };
     }
 
     class Registry final {
         friend class EntityComponentSystem;
         friend class systems::Systems;
+        friend class systems::TransformHierarchy;
+        friend class systems::TransformInterpolation;
+        friend class systems::RenderExtraction;
+        friend class systems::SpatialIndex;
         friend class EntityCommandBuffer;
-        friend struct sECSCommand;
+        friend class Snapshot;
+        friend class World;
+
+        using index_type = tEntity::index_type;
+        using generation_type = tEntity::generation_type;
+        static constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+
+        std::vector<generation_type> m_generations;
+        mutable std::atomic<uint64_t> m_indexCounter{0};
+
+        // Published set of reusable handles, generation already bumped. It is never modified once
+        // published: create() claims entries through the cursor, and playback swaps in a new set.
+        struct sFreeSlots {
+            std::vector<tEntity> handles;
+            std::atomic<size_t> cursor{0};
+        };
+
+        // A cursor at or past this value claims nothing, even though later fetch_adds keep moving it.
+        static constexpr size_t FREE_SLOTS_CLOSED = SIZE_MAX / 2;
+
+        // Indices destroyed since the last publishFreeList(). Only touched by the owning thread.
+        std::vector<index_type> m_freeList;
+        std::shared_ptr<sFreeSlots> m_freeSlots = std::make_shared<sFreeSlots>();
+        mutable std::mutex m_freeSlotsMutex;
+
+        // Dense set of live entities, m_aliveSlots maps an entity index to its slot in m_alive.
+        // Destroy swap-removes so create, destroy and liveness checks stay O(1).
+        std::vector<tEntity> m_alive;
+        std::vector<uint32_t> m_aliveSlots;
+
+        // Declared before the pools, which hand their pages back to it on destruction.
+        detail::BlockArena m_arena;
+
+        // Indexed by detail::componentTypeId<T>(), slots for unused types stay null.
+        std::vector<std::unique_ptr<detail::iComponentPool> > m_componentPools;
+        size_t m_compactCursor = 0;
+
+        // Free blocks kept around by compactStep() so the next spawn wave does not hit the allocator.
+        static constexpr size_t ARENA_KEEP_BLOCKS = 16;
 
-        std::vector<uint32_t> m_generations;
-        mutable std::atomic<uint32_t> m_indexCounter{0};
+        // Change tick stamped on component writes. Starts at 1 so a consumer whose last tick is 0 sees everything.
+        uint32_t m_tick = 1;
 
-        std::unordered_map<std::type_index, std::unique_ptr<detail::iComponentPool> > m_componentPools;
+        // Global resources, indexed by the same dense type ids as the pools.
+        std::vector<std::unique_ptr<detail::iSingleton> > m_singletons;
+
+        std::vector<std::unique_ptr<detail::OwningGroup> > m_groups;
+
+        // True unless _func can also be called with the K-th component as const.
+        template<size_t K, typename Func, typename... Ts>
+        static constexpr bool writesComponent() {
+            return []<size_t... J>(std::index_sequence<J...>) {
+                return !std::is_invocable_v<Func &, tEntity, std::conditional_t<J == K, const Ts &, Ts &>...>;
+            }(std::index_sequence_for<Ts...>{});
+        }
 
         template<typename T>
-        detail::ComponentPool<T> *getPool() {
-            auto typeIndex = std::type_index(typeid(T));
+        detail::PoolFor<T> *getPool() {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId >= m_componentPools.size()) m_componentPools.resize(typeId + 1);
 
-            if (!m_componentPools.contains(typeIndex)) {
-                m_componentPools[typeIndex] = std::make_unique<detail::ComponentPool<T> >();
+            auto &pool = m_componentPools[typeId];
+            if (!pool) {
+                if constexpr (std::is_empty_v<T>) pool = std::make_unique<detail::TagPool<T> >(&m_generations);
+                else pool = std::make_unique<detail::ComponentPool<T> >(&m_tick, &m_arena);
             }
-            return static_cast<detail::ComponentPool<T> *>(m_componentPools[typeIndex].get());
+            return static_cast<detail::PoolFor<T> *>(pool.get());
+        }
+
+        template<typename T>
+        const detail::PoolFor<T> *findPool() const {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId >= m_componentPools.size()) return nullptr;
+            return static_cast<const detail::PoolFor<T> *>(m_componentPools[typeId].get());
         }
 
         [[nodiscard]] bool isValid(const tEntity _entity) const noexcept {
-            const uint32_t idx = _entity.index();
+            const index_type idx = _entity.index();
 
             if (idx >= m_generations.size()) return false;
-            return m_generations[idx] == _entity.generation();
+            return m_generations[idx] == _entity.generation() && m_aliveSlots[idx] != NO_SLOT;
         }
 
+        /**
+         * @brief Reserves a handle, recycling a destroyed index when one is available.
+         * @note Safe to call from any thread, including during playback: it only reads the published
+         * free slots and the index counter. Returns NULL_ENTITY once every index is in use or retired.
+         */
         tEntity create() const {
-            const uint32_t idx = m_indexCounter.fetch_add(1, std::memory_order_relaxed);
-            return tEntity::make(idx, 1);
+            tEntity entity;
+            create(std::span(&entity, 1));
+            return entity;
+        }
+
+        void create(const std::span<tEntity> _out) const {
+            std::shared_ptr<sFreeSlots> slots;
+            {
+                std::lock_guard lock(m_freeSlotsMutex);
+                slots = m_freeSlots;
+            }
+
+            const size_t available = slots->handles.size();
+            const size_t first = slots->cursor.fetch_add(_out.size(), std::memory_order_relaxed);
+            const size_t recycled = first < available ? std::min(_out.size(), available - first) : 0;
+            if (recycled > 0) {
+                std::copy_n(slots->handles.begin() + static_cast<ptrdiff_t>(first), recycled, _out.begin());
+            }
+
+            const size_t fresh = _out.size() - recycled;
+            const uint64_t next = m_indexCounter.fetch_add(fresh, std::memory_order_relaxed);
+            for (size_t i = 0; i < fresh; ++i) {
+                _out[recycled + i] = next + i <= tEntity::MAX_INDEX
+                                         ? tEntity::make(static_cast<index_type>(next + i), 1)
+                                         : NULL_ENTITY;
+            }
         }
 
         void internal_registerCreate(tEntity _entity) {
-            const uint32_t idx = _entity.index();
-            if (idx >= m_generations.size())
-                m_generations.resize(idx + 1024, 0);
+            if (_entity.is_null()) return;
+
+            const index_type idx = _entity.index();
+            if (idx >= m_generations.size()) {
+                m_generations.resize(size_t{idx} + 1024, 0);
+                m_aliveSlots.resize(size_t{idx} + 1024, NO_SLOT);
+            }
+
+            if (m_aliveSlots[idx] != NO_SLOT) return;
+
+            m_generations[idx] = _entity.generation();
+            m_aliveSlots[idx] = static_cast<uint32_t>(m_alive.size());
+            m_alive.push_back(_entity);
+        }
+
+        void internal_registerCreate(const std::span<const tEntity> _entities) {
+            index_type maxIndex = 0;
+            for (const auto entity: _entities) {
+                if (!entity.is_null()) maxIndex = std::max(maxIndex, entity.index());
+            }
+
+            if (maxIndex >= m_generations.size()) {
+                m_generations.resize(size_t{maxIndex} + 1024, 0);
+                m_aliveSlots.resize(size_t{maxIndex} + 1024, NO_SLOT);
+            }
+            m_alive.reserve(m_alive.size() + _entities.size());
+
+            for (const auto entity: _entities) {
+                internal_registerCreate(entity);
+            }
         }
 
         void internalDestroy(tEntity _entity) {
             if (!isValid(_entity)) return;
 
-            const uint32_t idx = _entity.index();
-            if (m_generations[idx] != _entity.generation()) return;
-            for (const auto &pool: m_componentPools | std::views::values) {
-                pool->remove(_entity);
+            const index_type idx = _entity.index();
+            for (const auto &pool: m_componentPools) {
+                if (pool) pool->remove(_entity);
+            }
+
+            const uint32_t slot = m_aliveSlots[idx];
+            const tEntity last = m_alive.back();
+            m_alive[slot] = last;
+            m_aliveSlots[last.index()] = slot;
+            m_alive.pop_back();
+            m_aliveSlots[idx] = NO_SLOT;
+
+            // A slot whose generation would reach the reserved value is retired for good, so a stale
+            // handle can never alias a later entity.
+            if (++m_generations[idx] == tEntity::RETIRED_GENERATION) return;
+
+            m_freeList.push_back(idx);
+        }
+
+        /**
+         * @brief Makes indices destroyed since the last call available to create(), along with whatever
+         * the current slots have not handed out yet. Called at the end of playback.
+         *
+         * The old cursor is closed before its leftovers are copied, so a create() still holding the
+         * old slots cannot claim an entry that also lands in the new ones.
+         */
+        void publishFreeList() {
+            // Unclaimed entries of the current slots stay reachable through them.
+            if (m_freeList.empty()) return;
+
+            const size_t claimed = std::min(m_freeSlots->cursor.exchange(FREE_SLOTS_CLOSED, std::memory_order_relaxed),
+                                            m_freeSlots->handles.size());
+
+            auto next = std::make_shared<sFreeSlots>();
+            next->handles.reserve(m_freeSlots->handles.size() - claimed + m_freeList.size());
+            next->handles.assign(m_freeSlots->handles.begin() + static_cast<ptrdiff_t>(claimed), m_freeSlots->handles.end());
+            for (const index_type idx: m_freeList) next->handles.push_back(tEntity::make(idx, m_generations[idx]));
+            m_freeList.clear();
+
+            std::lock_guard lock(m_freeSlotsMutex);
+            m_freeSlots = std::move(next);
+        }
+
+        /**
+         * @brief Rebuilds the free list from the generations, e.g. after a snapshot restore.
+         */
+        void rebuildFreeList() {
+            // Everything published before is stale, drop it rather than carry it over.
+            m_freeSlots->cursor.store(FREE_SLOTS_CLOSED, std::memory_order_relaxed);
+            {
+                std::lock_guard lock(m_freeSlotsMutex);
+                m_freeSlots = std::make_shared<sFreeSlots>();
             }
+            m_freeList.clear();
 
-            m_generations[idx]++;
+            const auto end = std::min<uint64_t>(m_indexCounter.load(std::memory_order_relaxed), m_generations.size());
+            for (uint64_t idx = 0; idx < end; ++idx) {
+                if (m_aliveSlots[idx] == NO_SLOT && m_generations[idx] != tEntity::RETIRED_GENERATION) {
+                    m_freeList.push_back(static_cast<index_type>(idx));
+                }
+            }
+            publishFreeList();
         }
 
+        /**
+         * @brief Moves every entity and component of _source into this registry and leaves _source empty.
+         *
+         * Entities get fresh handles here; dense arrays move pool by pool instead of being replayed per
+         * entity, and components with EntityRemapHooks have their handles rewritten. Singletons and
+         * groups stay with their registry.
+         * @note Nothing may touch either registry while this runs.
+         */
+        EntityRemap merge(Registry &_source) {
+            if (&_source == this || _source.m_alive.empty()) return {};
+
+            std::vector<tEntity> created(_source.m_alive.size());
+            create(created);
+            if (std::ranges::any_of(created, &tEntity::is_null)) {
+                for (const auto entity: created) {
+                    if (!entity.is_null()) {
+                        internal_registerCreate(entity);
+                        internalDestroy(entity);
+                    }
+                }
+                logError("ECS", "World merge failed: not enough free entity indices for {} entities.",
+                         created.size());
+                return {};
+            }
+            internal_registerCreate(std::span<const tEntity>(created));
+
+            EntityRemap remap(_source.m_generations.size());
+            for (size_t i = 0; i < created.size(); ++i) {
+                remap.set(_source.m_alive[i], created[i]);
+            }
+
+            for (uint32_t typeId = 0; typeId < _source.m_componentPools.size(); ++typeId) {
+                const auto &pool = _source.m_componentPools[typeId];
+                if (!pool || pool->size() == 0) continue;
+
+                if (typeId >= m_componentPools.size()) m_componentPools.resize(typeId + 1);
+                auto &target = m_componentPools[typeId];
+                if (!target) target = pool->makeEmpty(&m_tick, &m_arena, &m_generations);
+
+                pool->mergeInto(*target, remap);
+            }
+
+            _source.releaseAll();
+            return remap;
+        }
+
+        /**
+         * @brief Kills every entity without touching the pools, whose contents were moved out already.
+         */
+        void releaseAll() {
+            for (const auto entity: m_alive) {
+                const index_type idx = entity.index();
+                m_aliveSlots[idx] = NO_SLOT;
+                if (++m_generations[idx] != tEntity::RETIRED_GENERATION) m_freeList.push_back(idx);
+            }
+            m_alive.clear();
+            publishFreeList();
+        }
+
+        /**
+         * @brief Indices available for reuse, published or still pending.
+         */
+        [[nodiscard]] size_t freeCount() const noexcept {
+            const size_t claimed = m_freeSlots->cursor.load(std::memory_order_relaxed);
+            const size_t published = m_freeSlots->handles.size();
+            return (claimed < published ? published - claimed : 0) + m_freeList.size();
+        }
+
+        [[nodiscard]] size_t aliveCount() const noexcept { return m_alive.size(); }
+        [[nodiscard]] std::span<const tEntity> alive() const noexcept { return m_alive; }
+
         template<typename T>
         T &addComponent(tEntity _entity, T _component) {
             auto *pool = getPool<T>();
@@ -155,50 +1356,331 @@ export namespace opn {
             return *pool->get(_entity);
         }
 
+        /**
+         * @brief Adds _components[i] to _entities[i], skipping handles that are not alive.
+         * @note _components must hold at least _entities.size() elements.
+         * @return Number of components added.
+         */
+        template<typename T>
+        size_t addComponents(const std::span<const tEntity> _entities, T *_components) {
+            auto *pool = getPool<T>();
+            if (std::ranges::all_of(_entities, [this](const tEntity _e) { return isValid(_e); })) {
+                pool->insertBatch(_entities, _components);
+                return _entities.size();
+            }
+
+            size_t added = 0;
+            pool->reserve(pool->size() + _entities.size());
+            for (size_t i = 0; i < _entities.size(); ++i) {
+                if (!isValid(_entities[i])) continue;
+                pool->insert(_entities[i], std::move(_components[i]));
+                ++added;
+            }
+            return added;
+        }
+
         template<typename T>
         void removeComponent(tEntity _entity) {
             auto *pool = getPool<T>();
             pool->remove(_entity);
         }
 
+        [[nodiscard]] uint32_t tick() const noexcept { return m_tick; }
+
+        /**
+         * @brief Closes the current tick for a change consumer.
+         * @return The tick to pass as _since on the consumer's next query.
+         */
+        uint32_t advanceTick() noexcept { return m_tick++; }
+
+        /**
+         * @brief Trims change/remove logs of every pool up to the oldest tick any consumer still holds.
+         */
+        void trimChangeLogs(const uint32_t _oldestTick) {
+            for (const auto &pool: m_componentPools) {
+                if (pool) pool->trimChangeLogs(_oldestTick);
+            }
+        }
+
+        /**
+         * @brief Releases spare capacity in every pool and returns all cached arena blocks to the OS.
+         */
+        void shrinkToFit() {
+            for (const auto &pool: m_componentPools) {
+                if (pool) pool->shrinkToFit();
+            }
+            m_alive.shrink_to_fit();
+            m_arena.trim(0);
+        }
+
+        /**
+         * @brief Incremental compaction, shrinks at most one pool per call.
+         * @return True if a pool was compacted.
+         */
+        bool compactStep() {
+            const size_t poolCount = m_componentPools.size();
+            for (size_t i = 0; i < poolCount; ++i) {
+                const auto &pool = m_componentPools[m_compactCursor++ % poolCount];
+                if (!pool || !pool->wantsCompaction()) continue;
+
+                pool->shrinkToFit();
+                m_arena.trim(ARENA_KEEP_BLOCKS);
+                return true;
+            }
+
+            m_arena.trim(ARENA_KEEP_BLOCKS);
+            return false;
+        }
+
+        [[nodiscard]] std::vector<detail::sPoolMemoryStats> memoryReport() const {
+            std::vector<detail::sPoolMemoryStats> report;
+            for (const auto &pool: m_componentPools) {
+                if (pool) report.push_back(pool->memoryStats());
+            }
+
+            report.push_back({
+                .name = "<entities>",
+                .count = m_alive.size(),
+                .denseBytes = m_alive.size() * sizeof(tEntity),
+                .reservedBytes = m_alive.capacity() * sizeof(tEntity),
+                .sparseBytes = m_generations.capacity() * sizeof(generation_type) +
+                               m_aliveSlots.capacity() * sizeof(uint32_t) + m_freeList.capacity() * sizeof(index_type)
+            });
+            return report;
+        }
+
+        [[nodiscard]] const detail::BlockArena &arena() const noexcept { return m_arena; }
+
+        /**
+         * @brief Creates T's pool up front, so a snapshot restore can find it by type hash.
+         */
+        template<typename T>
+        void registerComponent() {
+            getPool<T>();
+        }
+
+        /**
+         * @brief Mutable access, stamps the component as modified in the current tick.
+         */
         template<typename T>
         T *getComponent(tEntity _entity) {
             auto *pool = getPool<T>();
-            return pool->get(_entity);
+            if constexpr (std::is_empty_v<T>) {
+                return pool->get(_entity);
+            } else {
+                const uint32_t index = pool->denseIndex(_entity);
+                if (index == 0xFFFFFFFF) return nullptr;
+
+                pool->markChangedAt(index);
+                return &pool->components()[index];
+            }
+        }
+
+        template<typename T>
+        const T *getComponent(tEntity _entity) const {
+            const auto *pool = findPool<T>();
+            return pool ? pool->get(_entity) : nullptr;
         }
 
         template<typename T>
         [[nodiscard]] bool hasComponent(tEntity _entity) const {
-            auto typeIndex = std::type_index(typeid(T));
-            if (!m_componentPools.contains(typeIndex)) return false;
-            return m_componentPools.at(typeIndex)->has(_entity);
+            const auto *pool = findPool<T>();
+            return pool && pool->has(_entity);
         }
 
+        /**
+         * @brief Iterates every T. Callbacks taking T& stamp each component as modified; to stay
+         * read-only, take const T& (or const auto&).
+         * @note A mutating callback must name its parameter type, e.g. Transform&, not auto&.
+         */
         template<typename T, typename Func>
         void forEach(Func &&_func) {
             auto *pool = getPool<T>();
-            auto &components = pool->components();
-            auto &entities = pool->entities();
+            if constexpr (std::is_empty_v<T>) {
+                pool->each([&](const tEntity _entity) { _func(_entity, pool->instance()); });
+            } else {
+                auto &components = pool->components();
+                auto &entities = pool->entities();
+
+                constexpr bool writes = !std::is_invocable_v<Func &, tEntity, const T &>;
+                for (size_t i = 0; i < components.size(); ++i) {
+                    _func(entities[i], components[i]);
+                    if constexpr (writes) pool->markChangedAt(static_cast<uint32_t>(i));
+                }
+            }
+        }
 
-            for (size_t i = 0; i < components.size(); ++i) {
-                _func(entities[i], components[i]);
+        /**
+         * @brief Creates (or returns) the owning group for Owned, after which the owned pools keep their
+         * common entities packed at the front in matching order. forEach over any two of the owned
+         * types then walks the pools in lock-step.
+         * @return nullptr if one of the pools is already owned by a different group.
+         * @note Owned pools must not be re-sorted by anything else (e.g. the Hierarchy pool).
+         */
+        template<typename... Owned> requires (sizeof...(Owned) >= 2 && (!std::is_empty_v<Owned> && ...))
+        detail::OwningGroup *group() {
+            auto *first = getPool<std::tuple_element_t<0, std::tuple<Owned...> > >();
+            if (first->m_group && (first->m_group->owns(getPool<Owned>()) && ...)) return first->m_group;
+            if (((getPool<Owned>()->m_group != nullptr) || ...)) return nullptr;
+
+            auto &group = m_groups.emplace_back(std::make_unique<detail::OwningGroup>(
+                std::vector<detail::iComponentPool *>{getPool<Owned>()...}));
+            ((getPool<Owned>()->m_group = group.get()), ...);
+            group->rebuild();
+            return group.get();
+        }
+
+        /**
+         * @brief Lock-step iteration over a group's packed range, _func(entity, Owned&...). The range
+         * holds the entities that have every type the group owns, not just the ones listed here.
+         * @note The first of Owned must belong to a group created by group<...>().
+         */
+        template<typename... Owned, typename Func>
+        void forEachOwned(Func &&_func) {
+            const std::tuple pools{getPool<Owned>()...};
+            const auto *group = std::get<0>(pools)->m_group;
+            if (!group || !std::apply([group](const auto *... _pools) { return (group->owns(_pools) && ...); }, pools)) {
+                return;
             }
+
+            const tEntity *entities = std::get<0>(pools)->entities().data();
+            const uint32_t count = group->size();
+
+            [&]<size_t... K>(std::index_sequence<K...>) {
+                const std::tuple components{std::get<K>(pools)->components().data()...};
+                for (uint32_t i = 0; i < count; ++i) {
+                    _func(entities[i], std::get<K>(components)[i]...);
+                    ((writesComponent<K, Func, Owned...>() ? std::get<K>(pools)->markChangedAt(i) : void()), ...);
+                }
+            }(std::index_sequence_for<Owned...>{});
         }
 
+        /**
+         * @brief Iterates entities holding both T1 and T2. Tag types are tested with a bit lookup;
+         * if T1 is a tag and T2 is not, T2's dense array drives the loop instead. Pools owned by the
+         * same two-type group are walked in lock-step.
+         */
         template<typename T1, typename T2, typename Func>
         void forEach(Func &&_func) {
             auto *pool1 = getPool<T1>();
             auto *pool2 = getPool<T2>();
 
-            auto &entities1 = pool1->entities();
-            auto &components1 = pool1->components();
+            if constexpr (std::is_empty_v<T1> && std::is_empty_v<T2>) {
+                pool1->each([&](const tEntity _entity) {
+                    if (pool2->has(_entity)) _func(_entity, pool1->instance(), pool2->instance());
+                });
+            } else if constexpr (std::is_empty_v<T1>) {
+                auto &entities2 = pool2->entities();
+                auto &components2 = pool2->components();
+
+                constexpr bool writes2 = !std::is_invocable_v<Func &, tEntity, T1 &, const T2 &>;
+                for (size_t i = 0; i < entities2.size(); ++i) {
+                    if (!pool1->has(entities2[i])) continue;
+                    _func(entities2[i], pool1->instance(), components2[i]);
+                    if constexpr (writes2) pool2->markChangedAt(static_cast<uint32_t>(i));
+                }
+            } else if constexpr (std::is_empty_v<T2>) {
+                auto &entities1 = pool1->entities();
+                auto &components1 = pool1->components();
+
+                constexpr bool writes1 = !std::is_invocable_v<Func &, tEntity, const T1 &, T2 &>;
+                for (size_t i = 0; i < entities1.size(); ++i) {
+                    if (!pool2->has(entities1[i])) continue;
+                    _func(entities1[i], components1[i], pool2->instance());
+                    if constexpr (writes1) pool1->markChangedAt(static_cast<uint32_t>(i));
+                }
+            } else if (pool1->m_group && pool1->m_group == pool2->m_group && pool1->m_group->poolCount() == 2) {
+                forEachOwned<T1, T2>(std::forward<Func>(_func));
+            } else {
+                auto &entities1 = pool1->entities();
+                auto &components1 = pool1->components();
+
+                constexpr bool writes1 = !std::is_invocable_v<Func &, tEntity, const T1 &, T2 &>;
+                constexpr bool writes2 = !std::is_invocable_v<Func &, tEntity, T1 &, const T2 &>;
+                for (size_t i = 0; i < entities1.size(); ++i) {
+                    tEntity entity = entities1[i];
+                    const uint32_t index2 = pool2->denseIndex(entity);
+                    if (index2 == 0xFFFFFFFF) continue;
+
+                    _func(entity, components1[i], pool2->components()[index2]);
+                    if constexpr (writes1) pool1->markChangedAt(static_cast<uint32_t>(i));
+                    if constexpr (writes2) pool2->markChangedAt(index2);
+                }
+            }
+        }
+
+        /**
+         * @brief Calls _func(entity, const T&) for each T added or modified after tick _since.
+         */
+        template<typename T, typename Func>
+        void forEachChanged(const uint32_t _since, Func &&_func) const {
+            static_assert(!std::is_empty_v<T>, "Tag components are not change tracked");
+            if (const auto *pool = findPool<T>()) pool->forEachChanged(_since, std::forward<Func>(_func));
+        }
+
+        template<typename T, typename Func>
+        void forEachAdded(const uint32_t _since, Func &&_func) const {
+            static_assert(!std::is_empty_v<T>, "Tag components are not change tracked");
+            if (const auto *pool = findPool<T>()) pool->forEachAdded(_since, std::forward<Func>(_func));
+        }
+
+        template<typename T, typename Func>
+        void forEachRemoved(const uint32_t _since, Func &&_func) const {
+            static_assert(!std::is_empty_v<T>, "Tag components are not change tracked");
+            if (const auto *pool = findPool<T>()) pool->forEachRemoved(_since, std::forward<Func>(_func));
+        }
+
+        /**
+         * @brief Calls _func(entity) for every entity carrying all of Tags, a word-wise AND of the bitsets.
+         */
+        template<typename... Tags, typename Func> requires (sizeof...(Tags) > 0 && (std::is_empty_v<Tags> && ...))
+        void forEachTagged(Func &&_func) const {
+            const std::array<const detail::iComponentPool *, sizeof...(Tags)> untyped{findPool<Tags>()...};
+            if (std::ranges::any_of(untyped, [](const auto *_pool) { return _pool == nullptr; })) return;
+
+            const std::array words{findPool<Tags>()->words()...};
+            const size_t wordCount = std::ranges::min(words, {}, [](const auto &_w) { return _w.size(); }).size();
 
-            for (size_t i = 0; i < entities1.size(); ++i) {
-                tEntity entity = entities1[i];
-                if (auto *comp2 = pool2->get(entity)) {
-                    _func(entity, components1[i], *comp2);
+            for (size_t w = 0; w < wordCount; ++w) {
+                uint64_t bits = ~uint64_t{0};
+                for (const auto &tagWords: words) bits &= tagWords[w];
+
+                for (; bits; bits &= bits - 1) {
+                    const auto index = static_cast<index_type>(w * 64 + std::countr_zero(bits));
+                    _func(tEntity::make(index, m_generations[index]));
                 }
             }
         }
+
+        template<typename T, typename... Args>
+        T &emplaceSingleton(Args &&... _args) {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId >= m_singletons.size()) m_singletons.resize(typeId + 1);
+
+            auto singleton = std::make_unique<detail::Singleton<T> >(std::forward<Args>(_args)...);
+            T &value = singleton->value;
+            m_singletons[typeId] = std::move(singleton);
+            return value;
+        }
+
+        template<typename T>
+        T *getSingleton() {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId >= m_singletons.size() || !m_singletons[typeId]) return nullptr;
+            return &static_cast<detail::Singleton<T> *>(m_singletons[typeId].get())->value;
+        }
+
+        template<typename T>
+        const T *getSingleton() const {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId >= m_singletons.size() || !m_singletons[typeId]) return nullptr;
+            return &static_cast<const detail::Singleton<T> *>(m_singletons[typeId].get())->value;
+        }
+
+        template<typename T>
+        void removeSingleton() {
+            const uint32_t typeId = detail::componentTypeId<T>();
+            if (typeId < m_singletons.size()) m_singletons[typeId].reset();
+        }
     };
 }
@@ -0,0 +1,204 @@
+module;
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+#include "hlsl++.h"
+export module opn.ECS:RenderExtraction;
+import :Registry;
+import :ECB;
+import :Hierarchy;
+import :Interpolation;
+import :tEntity;
+import opn.ECS.Components;
+import opn.Assets.Types;
+import opn.Renderer.Types;
+import opn.System.Jobs.Types;
+import opn.Utils.Locator;
+
+export namespace opn::systems {
+    /**
+     * @brief Walks Transform + Renderable once per frame and writes a packed, key-sorted draw list
+     * into a frame arena.
+     *
+     * The candidate range is cut into fixed-size chunks that workers pull from a shared counter.
+     * Every chunk writes into its own slice of the arena, so the only synchronisation is the final
+     * fence wait. Skipped entities leave gaps that are closed before sorting.
+     *
+     * With the group, world matrices come from a TransformSoA mirror of the group's Transforms that
+     * persists across frames. A chunk only re-gathers and rebuilds the lane blocks holding a Transform
+     * written since the last extract; an insert or removal in either pool refreshes everything.
+     */
+    class RenderExtraction final {
+        static constexpr size_t CHUNK_SIZE = 4096;
+        // The draw list is one allocation, so anything past twice its size is stale. Small scenes keep
+        // up to this much to avoid reallocating every frame.
+        static constexpr size_t ARENA_KEEP_BYTES = 1024 * 1024;
+        static constexpr size_t LANE_WIDTH = components::TransformSoA::LANE_WIDTH;
+        static_assert(CHUNK_SIZE % LANE_WIDTH == 0, "Chunks must not share a lane block of the mirror");
+
+        Registry *m_registry = nullptr;
+        const TransformInterpolation *m_interpolation = nullptr;
+        detail::LinearArena m_frameArena;
+        std::vector<uint32_t> m_chunkCounts;
+        std::vector<uint32_t> m_fences;
+
+        // Grouped path only, indexed by dense slot.
+        components::TransformSoA m_soa;
+        std::vector<hlslpp::float4x4> m_worlds;
+        uint64_t m_transformVersion = UINT64_MAX;
+        uint64_t m_renderableVersion = UINT64_MAX;
+        uint32_t m_lastTick = 0;
+
+        /**
+         * @brief Brings slots [_first, _last) of the mirror up to date. Runs concurrently for different
+         * chunks; _first is lane aligned, so no two calls touch the same block.
+         */
+        void refreshMirror(const detail::PoolFor<components::Transform> &_transforms, const size_t _first,
+                           const size_t _last, const uint32_t _since, const bool _all) {
+            const auto &transforms = _transforms.components();
+            const auto ticks = _transforms.changedTicks();
+
+            // Consecutive dirty blocks are built in one call so the kernel runs full width.
+            size_t runStart = _last;
+            const auto buildRun = [&](const size_t _end) {
+                if (runStart == _last) return;
+                components::buildWorldMatrices(m_soa, std::span(m_worlds).subspan(runStart, _end - runStart), runStart);
+                runStart = _last;
+            };
+
+            for (size_t block = _first; block < _last; block += LANE_WIDTH) {
+                const size_t end = std::min(_last, block + LANE_WIDTH);
+                const bool dirty = _all || std::any_of(ticks.begin() + block, ticks.begin() + end,
+                                                       [_since](const uint32_t _tick) { return _tick > _since; });
+                if (!dirty) {
+                    buildRun(block);
+                    continue;
+                }
+
+                for (size_t i = block; i < end; ++i) m_soa.set(i, transforms[i]);
+                if (runStart == _last) runStart = block;
+            }
+            buildRun(_last);
+        }
+
+    public:
+        explicit RenderExtraction(Registry &_registry, const TransformInterpolation *_interpolation = nullptr)
+            : m_registry(&_registry), m_interpolation(_interpolation) {}
+
+        /**
+         * @brief Builds this frame's draw list. Entities moved in the last fixed step are drawn
+         * between their previous and current matrix by _alpha, see Time::getPhysicsInterpolationFactor().
+         * @note The returned span lives in the frame arena and is invalidated by the next call.
+         */
+        [[nodiscard]] std::span<const sDrawRecord> extract(const float _alpha = 1.0f) {
+            m_frameArena.reset();
+
+            const auto *transforms = m_registry->getPool<components::Transform>();
+            const auto *renderables = m_registry->getPool<components::Renderable>();
+            // Most worlds have no parented entities, skip the per-entity sparse lookup for them.
+            const auto *hierarchy = m_registry->findPool<components::Hierarchy>();
+            if (hierarchy && hierarchy->size() == 0) hierarchy = nullptr;
+
+            // With the Transform + Renderable group the leading slots line up, otherwise Renderable
+            // drives and each Transform is looked up.
+            const auto *group = renderables->owningGroup();
+            const bool grouped = group && group == transforms->owningGroup() && group->poolCount() == 2;
+            const size_t count = grouped ? group->size() : renderables->size();
+
+            // A list that outgrows every block gets a new one, so without this the arena only grows.
+            const size_t bytes = count * sizeof(sDrawRecord);
+            m_frameArena.trim(std::max(bytes * 2, ARENA_KEEP_BYTES));
+            if (count == 0) return {};
+
+            auto *records = static_cast<sDrawRecord *>(m_frameArena.allocate(bytes, alignof(sDrawRecord)));
+
+            // Inserts and removals can move slots around without stamping a tick, refresh all then.
+            bool refreshAll = false;
+            const uint32_t since = m_lastTick;
+            if (grouped) {
+                refreshAll = transforms->version() != m_transformVersion ||
+                             renderables->version() != m_renderableVersion || m_soa.size() != count;
+                if (refreshAll) {
+                    m_soa.resize(count);
+                    m_worlds.resize(count);
+                    m_transformVersion = transforms->version();
+                    m_renderableVersion = renderables->version();
+                }
+                m_lastTick = m_registry->advanceTick();
+            }
+
+            const bool interpolate = m_interpolation && _alpha < 1.0f;
+            const size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            m_chunkCounts.assign(chunks, 0);
+
+            const auto extractChunk = [&](const size_t _chunk) {
+                const size_t first = _chunk * CHUNK_SIZE;
+                const size_t last = std::min(count, first + CHUNK_SIZE);
+                const auto &entities = renderables->entities();
+                const auto &components = renderables->components();
+                if (grouped) refreshMirror(*transforms, first, last, since, refreshAll);
+
+                sDrawRecord *out = records + first;
+                uint32_t written = 0;
+                for (size_t i = first; i < last; ++i) {
+                    const auto &renderable = components[i];
+                    if (!renderable.visible) continue;
+
+                    const tEntity entity = entities[i];
+                    const auto *transform = grouped ? nullptr : transforms->get(entity);
+                    if (!grouped && !transform) continue;
+
+                    const auto *node = hierarchy ? hierarchy->get(entity) : nullptr;
+                    const uint64_t mesh = sAssetHandleHasher{}(renderable.meshHandle);
+                    const uint64_t material = sAssetHandleHasher{}(renderable.materialHandle);
+
+                    const hlslpp::float4x4 world = node ? node->world
+                                                   : grouped ? m_worlds[i]
+                                                   : transform->getMatrix();
+
+                    std::construct_at(out + written++, sDrawRecord{
+                                          .sortKey = makeDrawSortKey(material, mesh),
+                                          .mesh = mesh,
+                                          .material = material,
+                                          .world = interpolate ? m_interpolation->blend(entity, world, _alpha) : world
+                                      });
+                }
+                m_chunkCounts[_chunk] = written;
+            };
+
+            std::atomic<size_t> nextChunk{0};
+            const auto drain = [&] {
+                for (size_t chunk; (chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+                    extractChunk(chunk);
+                }
+            };
+
+            m_fences.clear();
+            if (chunks > 1 && Locator::hasJobDispatcher()) {
+                const size_t workers = std::min<size_t>(chunks - 1, std::max(1u, std::thread::hardware_concurrency()) - 1);
+                for (size_t i = 0; i < workers; ++i) {
+                    m_fences.push_back(Locator::submit(eJobType::General, [&drain] { drain(); }).fenceID);
+                }
+            }
+            drain();
+            for (const uint32_t fence: m_fences) Locator::waitFence(fence);
+
+            size_t total = 0;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                sDrawRecord *first = records + chunk * CHUNK_SIZE;
+                if (records + total != first) std::move(first, first + m_chunkCounts[chunk], records + total);
+                total += m_chunkCounts[chunk];
+            }
+
+            std::sort(records, records + total, [](const sDrawRecord &_a, const sDrawRecord &_b) {
+                return _a.sortKey < _b.sortKey;
+            });
+            return {records, total};
+        }
+    };
+}
@@ -1,35 +1,60 @@
 module;
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <utility>
 #include <vector>
+#include "hlsl++.h"
 export module opn.ECS:Service;
 
 import opn.System.ServiceInterface;
 import :Registry;
+import :Hierarchy;
 import :Systems;
 import :ECB;
+import :Snapshot;
+import :World;
+import :Spatial;
 import opn.ECS.Components;
 import opn.Utils.Logging;
 import opn.System.Jobs.Dispatcher;
 
 export namespace opn {
+    /**
+     * @brief Owns the world. The simulation advances in fixed steps: each step plays back queued
+     * commands, runs the systems and rebuilds hierarchy and spatial data with the fixed delta.
+     * Frames without a due step leave the world as the last step left it.
+     */
     class EntityComponentSystem final : public Service<EntityComponentSystem> {
         // Data
         Registry m_registry;
         systems::Systems m_systems{m_registry};
 
-        mutable std::vector<tEntity> m_allEntities;
         mutable EntityCommandBuffer m_ecb;
 
+        // Pool compaction only runs on frames where the ECS update itself stayed under this budget.
+        static constexpr std::chrono::microseconds COMPACTION_BUDGET{1000};
+
     protected:
         void onInit() override {
+            // Pools must exist for snapshot restore to match them by type hash.
+            m_registry.registerComponent<components::Transform>();
+            m_registry.registerComponent<components::Renderable>();
+            m_registry.registerComponent<components::ShaderOverride>();
+            m_registry.registerComponent<components::Hierarchy>();
+            m_registry.registerComponent<components::Bounds>();
+
+            // Render extraction walks Transform + Renderable every frame, keep that pair packed.
+            m_registry.group<components::Transform, components::Renderable>();
+
             logInfo("ECS", "Entity Component System initialized.");
         }
 
         void onShutdown() override {
-            logInfo("ECS", "Shutting down ECS...");
-
-            for (const auto entity: m_allEntities) {
-            }
-            m_allEntities.clear();
+            logInfo("ECS", "Shutting down ECS... {} entities alive.", m_registry.aliveCount());
+            logMemoryReport();
 
             logInfo("ECS", "ECS shutdown complete.");
         }
@@ -39,25 +64,82 @@ export namespace opn {
         }
 
         void onUpdate(const float _deltaTime) override {
+            const auto start = std::chrono::steady_clock::now();
+
             m_ecb.playback(m_registry);
 
             m_systems.rotateAll(_deltaTime);
+            m_systems.updateHierarchy();
+            m_systems.updateSpatial();
+            m_systems.updateInterpolation();
+
+            m_registry.trimChangeLogs(m_systems.oldestTick());
+
+            if (std::chrono::steady_clock::now() - start < COMPACTION_BUDGET) {
+                m_registry.compactStep();
+            }
         }
 
     public:
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::FixedStep;
+
         tEntity createEntity() const {
             const tEntity entity = m_registry.create();
-            m_ecb.enqueue(sECSCommand::Create(entity, m_allEntities));
+            m_ecb.create(entity);
             return entity;
         }
 
+        /**
+         * @brief Reserves one entity per element of _out in one step and queues a single batched create.
+         */
+        void createEntities(const std::span<tEntity> _out) const {
+            m_registry.create(_out);
+            m_ecb.create(std::span<const tEntity>(_out));
+        }
+
         void destroyEntity(const tEntity _entity) {
-            m_ecb.enqueue(sECSCommand::Destroy(_entity, m_allEntities));
+            m_ecb.destroy(_entity);
         }
 
         template<typename T>
         void addComponent(tEntity _entity, T _component) const {
-            m_ecb.enqueue(sECSCommand::AddComponent(_entity, std::move(_component)));
+            m_ecb.addComponent(_entity, std::move(_component));
+        }
+
+        /**
+         * @brief Queues one component per entity, applied as a single pool insert on playback.
+         */
+        template<typename T>
+        void addComponents(const std::span<const tEntity> _entities, const std::span<const T> _components) const {
+            m_ecb.addComponents(_entities, _components);
+        }
+
+        /**
+         * @brief Queues a parent link, the child's world matrix becomes local * parent world.
+         * @note Pass NULL_ENTITY to make _child a root again.
+         */
+        void setParent(const tEntity _child, const tEntity _parent) const {
+            m_ecb.addComponent(_child, components::Hierarchy{.parent = _parent});
+        }
+
+        [[nodiscard]] const hlslpp::float4x4 *getWorldMatrix(const tEntity _entity) {
+            return m_systems.hierarchy().getWorld(_entity);
+        }
+
+        /**
+         * @brief Entities whose Bounds overlap the box, as of the last update.
+         * @note Each query reuses one result buffer, the span is invalidated by the next query.
+         */
+        std::span<const tEntity> queryAABB(const hlslpp::float3 &_min, const hlslpp::float3 &_max) {
+            return m_systems.spatial().queryAABB(_min, _max);
+        }
+
+        std::span<const tEntity> querySphere(const hlslpp::float3 &_center, const float _radius) {
+            return m_systems.spatial().querySphere(_center, _radius);
+        }
+
+        std::span<const tEntity> queryFrustum(const sFrustum &_frustum) {
+            return m_systems.spatial().queryFrustum(_frustum);
         }
 
         template<typename T>
@@ -65,27 +147,150 @@ export namespace opn {
             m_registry.removeComponent<T>(_entity);
         }
 
+        /**
+         * @brief Write access, the component counts as modified for change queries this tick.
+         */
         template<typename T>
         T *getComponent(tEntity _entity) {
             return m_registry.getComponent<T>(_entity);
         }
 
+        template<typename T>
+        const T *getComponent(tEntity _entity) const {
+            return std::as_const(m_registry).getComponent<T>(_entity);
+        }
+
+        /**
+         * @brief Calls _func(entity, const T&) for each T added or modified after tick _since.
+         * @note Store advanceChangeTick() after a pass and pass it as _since next time.
+         */
+        template<typename T, typename Func>
+        void forEachChanged(const uint32_t _since, Func &&_func) const {
+            m_registry.forEachChanged<T>(_since, std::forward<Func>(_func));
+        }
+
+        template<typename T, typename Func>
+        void forEachRemoved(const uint32_t _since, Func &&_func) const {
+            m_registry.forEachRemoved<T>(_since, std::forward<Func>(_func));
+        }
+
+        /**
+         * @brief Closes the current change tick, writes after this call belong to the next one.
+         */
+        uint32_t advanceChangeTick() {
+            return m_registry.advanceTick();
+        }
+
         template<typename T>
         bool hasComponent(tEntity _entity) const {
             return m_registry.hasComponent<T>(_entity);
         }
 
-        void executeRenderSystems() {
-            m_systems.renderMeshes();
+        /**
+         * @brief Calls _func(entity) for every entity carrying all of the given tag (empty) components.
+         */
+        template<typename... Tags, typename Func>
+        void forEachTagged(Func &&_func) const {
+            m_registry.forEachTagged<Tags...>(std::forward<Func>(_func));
         }
 
+        /**
+         * @brief Creates or replaces the world-wide instance of T, e.g. input state or frame timing.
+         */
+        template<typename T, typename... Args>
+        T &setSingleton(Args &&... _args) {
+            return m_registry.emplaceSingleton<T>(std::forward<Args>(_args)...);
+        }
+
+        template<typename T>
+        [[nodiscard]] T *getSingleton() {
+            return m_registry.getSingleton<T>();
+        }
+
+        template<typename T>
+        void removeSingleton() {
+            m_registry.removeSingleton<T>();
+        }
+
+        /**
+         * @brief Extracts the draw list and hands it to the backend. The engine loop calls this once
+         * per frame, after the fixed steps and before Rendering's PostFrame update.
+         * @param _alpha Time::getPhysicsInterpolationFactor(), how far the frame is past the last step.
+         */
+        void executeRenderSystems(const float _alpha) {
+            m_systems.renderMeshes(_alpha);
+        }
+
+
+        /**
+         * @brief Flushes pending commands and captures the world as a flat snapshot blob.
+         */
+        [[nodiscard]] std::vector<std::byte> captureSnapshot() {
+            m_ecb.playback(m_registry);
+            return Snapshot::capture(m_registry);
+        }
+
+        bool restoreSnapshot(const std::span<const std::byte> _blob) {
+            m_ecb.playback(m_registry);
+            return Snapshot::restore(m_registry, _blob);
+        }
+
+        bool saveSnapshot(const std::filesystem::path &_path) {
+            m_ecb.playback(m_registry);
+            return Snapshot::save(m_registry, _path);
+        }
+
+        /**
+         * @brief Memory-maps _path and restores the world from it.
+         * @note Custom component types must be registered via registerComponent<T>() first.
+         */
+        bool loadSnapshot(const std::filesystem::path &_path) {
+            m_ecb.playback(m_registry);
+            return Snapshot::load(m_registry, _path);
+        }
+
+        /**
+         * @brief Moves everything in _world into the live world in one bulk step, leaving _world empty.
+         * @return Maps handles from _world to the live handles they became.
+         * @note Main thread only, and whoever built _world must be done with it.
+         */
+        EntityRemap mergeWorld(World &_world) {
+            m_ecb.playback(m_registry);
+            return m_registry.merge(_world.m_registry);
+        }
+
+        template<typename T>
+        void registerComponent() {
+            m_registry.registerComponent<T>();
+        }
+
+        /**
+         * @brief Releases all spare pool memory at once, e.g. right after a level unload.
+         */
+        void compactMemory() {
+            m_registry.shrinkToFit();
+        }
+
+        void logMemoryReport() const {
+            size_t total = 0;
+            for (const auto &stats: m_registry.memoryReport()) {
+                total += stats.reservedBytes + stats.sparseBytes + stats.logBytes;
+                logInfo("ECS", "{:<40} {:>8} live | dense {:>10} / {:>10} B | sparse {:>10} B | log {:>8} B",
+                        stats.name, stats.count, stats.denseBytes, stats.reservedBytes, stats.sparseBytes,
+                        stats.logBytes);
+            }
+
+            const auto &arena = m_registry.arena();
+            logInfo("ECS", "Total {} B, sparse arena {} B in use / {} B reserved.", total, arena.usedBytes(),
+                    arena.reservedBytes());
+        }
 
         [[nodiscard]] size_t getEntityCount() const noexcept {
-            return m_allEntities.size();
+            return m_registry.aliveCount();
         }
 
         [[nodiscard]] bool isEntityValid(tEntity _entity) const noexcept {
-            return std::ranges::find(m_allEntities, _entity) != m_allEntities.end();
+            return m_registry.isValid(_entity);
         }
     };
 }
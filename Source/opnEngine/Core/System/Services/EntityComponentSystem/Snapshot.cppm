@@ -0,0 +1,336 @@
+module;
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define VC_EXTRALEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module opn.ECS:Snapshot;
+import :Registry;
+import :tEntity;
+import opn.Utils.Logging;
+
+export namespace opn {
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     */
+    class MappedFile {
+        const std::byte *m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+        HANDLE m_mapping = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::filesystem::path &_path) {
+#ifdef _WIN32
+            m_file = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE) return;
+
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) return;
+
+            m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_mapping) return;
+
+            m_data = static_cast<const std::byte *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data) m_size = static_cast<size_t>(size.QuadPart);
+#else
+            const int fd = ::open(_path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat info{};
+            if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+                void *data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    m_data = static_cast<const std::byte *>(data);
+                    m_size = static_cast<size_t>(info.st_size);
+                }
+            }
+            ::close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (m_data) UnmapViewOfFile(m_data);
+            if (m_mapping) CloseHandle(m_mapping);
+            if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+            if (m_data) ::munmap(const_cast<std::byte *>(m_data), m_size);
+#endif
+        }
+
+        [[nodiscard]] bool isValid() const noexcept { return m_data != nullptr; }
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return {m_data, m_size}; }
+    };
+
+    /**
+     * @brief Flat, versioned world snapshot.
+     *
+     * Layout: header, generations, live entities, pool table sorted by type hash, then one
+     * component array and one entity array per pool. Every section starts on a 64-byte boundary
+     * and padding is zeroed, so the same world always produces the same bytes (components stored
+     * raw carry their own padding, give them hooks if that matters). Restoring copies each array in
+     * bulk and rebuilds the sparse pages; nothing is reinserted entity by entity.
+     *
+     * Pools are matched by componentTypeHash(). Components without a SnapshotName hash the compiler's
+     * spelling of their type, so their data only reloads in builds from the same compiler.
+     */
+    class Snapshot final {
+    public:
+        static constexpr uint32_t MAGIC = 0x534E504F; // "OPNS"
+        static constexpr uint32_t VERSION = 3;
+        static constexpr size_t SECTION_ALIGN = 64;
+
+        struct sHeader {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint64_t totalSize = 0;
+            uint32_t entityBits = 0;
+            uint32_t indexBits = 0;
+            uint64_t indexCounter = 0;
+            uint32_t generationCount = 0;
+            uint32_t aliveCount = 0;
+            uint32_t poolCount = 0;
+            uint64_t generationsOffset = 0;
+            uint64_t aliveOffset = 0;
+            uint64_t poolsOffset = 0;
+        };
+
+        struct sPoolRecord {
+            uint64_t typeHash = 0;
+            uint32_t stride = 0;
+            uint32_t count = 0;
+            uint64_t componentsOffset = 0;
+            uint64_t entitiesOffset = 0;
+        };
+
+        static_assert(std::endian::native == std::endian::little, "Snapshots are stored little-endian");
+
+    private:
+        static size_t align(const size_t _offset) noexcept {
+            return (_offset + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+        }
+
+        template<typename T>
+        static const T *at(const std::span<const std::byte> _blob, const uint64_t _offset, const size_t _count) {
+            if (_offset % alignof(T) != 0 || _offset > _blob.size() || _count * sizeof(T) > _blob.size() - _offset) {
+                return nullptr;
+            }
+            return reinterpret_cast<const T *>(_blob.data() + _offset);
+        }
+
+    public:
+        [[nodiscard]] static std::vector<std::byte> capture(const Registry &_registry) {
+            std::vector<const detail::iComponentPool *> pools;
+            for (const auto &pool: _registry.m_componentPools) {
+                if (!pool || pool->size() == 0) continue;
+                if (!pool->snapshotEnabled()) {
+                    logWarning("ECS", "Snapshot skips component type {:016x}, it is neither trivially copyable "
+                               "nor provides snapshot hooks.", pool->typeHash());
+                    continue;
+                }
+                pools.push_back(pool.get());
+            }
+            std::ranges::sort(pools, {}, [](const auto *_pool) { return _pool->typeHash(); });
+
+            sHeader header{
+                .magic = MAGIC,
+                .version = VERSION,
+                .entityBits = sizeof(tEntity) * 8,
+                .indexBits = tEntityTraits::INDEX_BITS,
+                .indexCounter = _registry.m_indexCounter.load(std::memory_order_relaxed),
+                .generationCount = static_cast<uint32_t>(_registry.m_generations.size()),
+                .aliveCount = static_cast<uint32_t>(_registry.m_alive.size()),
+                .poolCount = static_cast<uint32_t>(pools.size())
+            };
+
+            size_t offset = align(sizeof(sHeader));
+            header.generationsOffset = offset;
+            offset = align(offset + header.generationCount * sizeof(tEntity::generation_type));
+            header.aliveOffset = offset;
+            offset = align(offset + header.aliveCount * sizeof(tEntity));
+            header.poolsOffset = offset;
+            offset = align(offset + pools.size() * sizeof(sPoolRecord));
+
+            std::vector<sPoolRecord> records;
+            records.reserve(pools.size());
+            for (const auto *pool: pools) {
+                sPoolRecord record{
+                    .typeHash = pool->typeHash(),
+                    .stride = static_cast<uint32_t>(pool->snapshotStride()),
+                    .count = static_cast<uint32_t>(pool->size())
+                };
+                record.componentsOffset = offset;
+                offset = align(offset + size_t{record.count} * record.stride);
+                record.entitiesOffset = offset;
+                offset = align(offset + size_t{record.count} * sizeof(tEntity));
+                records.push_back(record);
+            }
+            header.totalSize = offset;
+
+            std::vector<std::byte> blob(offset);
+            std::memcpy(blob.data(), &header, sizeof(header));
+            std::memcpy(blob.data() + header.generationsOffset, _registry.m_generations.data(),
+                        header.generationCount * sizeof(tEntity::generation_type));
+            std::memcpy(blob.data() + header.aliveOffset, _registry.m_alive.data(),
+                        header.aliveCount * sizeof(tEntity));
+            std::memcpy(blob.data() + header.poolsOffset, records.data(), records.size() * sizeof(sPoolRecord));
+
+            for (size_t i = 0; i < pools.size(); ++i) {
+                pools[i]->writeSnapshot(blob.data() + records[i].componentsOffset,
+                                        reinterpret_cast<tEntity *>(blob.data() + records[i].entitiesOffset));
+            }
+            return blob;
+        }
+
+        /**
+         * @brief Replaces the registry's world with the one in _blob.
+         * @note Component types present in the blob must already have a pool in _registry;
+         * pools of types missing from the blob are cleared.
+         */
+        static bool restore(Registry &_registry, const std::span<const std::byte> _blob) {
+            const auto *header = at<sHeader>(_blob, 0, 1);
+            if (!header || header->magic != MAGIC || header->version != VERSION || header->totalSize > _blob.size()) {
+                logError("ECS", "Snapshot restore failed: bad header.");
+                return false;
+            }
+            if (header->entityBits != sizeof(tEntity) * 8 || header->indexBits != tEntityTraits::INDEX_BITS) {
+                logError("ECS", "Snapshot restore failed: saved with {}-bit handles ({} index bits), this build uses "
+                         "{} ({}).", header->entityBits, header->indexBits, sizeof(tEntity) * 8,
+                         tEntityTraits::INDEX_BITS);
+                return false;
+            }
+
+            const auto *generations = at<tEntity::generation_type>(_blob, header->generationsOffset, header->generationCount);
+            const auto *alive = at<tEntity>(_blob, header->aliveOffset, header->aliveCount);
+            const auto *records = at<sPoolRecord>(_blob, header->poolsOffset, header->poolCount);
+            if (!generations || !alive || !records) {
+                logError("ECS", "Snapshot restore failed: truncated blob.");
+                return false;
+            }
+
+            for (uint32_t i = 0; i < header->poolCount; ++i) {
+                const auto &record = records[i];
+                if (!at<std::byte>(_blob, record.componentsOffset, size_t{record.count} * record.stride) ||
+                    !at<tEntity>(_blob, record.entitiesOffset, record.count)) {
+                    logError("ECS", "Snapshot restore failed: pool {:016x} out of bounds.", record.typeHash);
+                    return false;
+                }
+            }
+
+            // Handles index straight into the registry's arrays, so every one is checked before anything
+            // is replaced: live entities must be unique, match their generation and lie below the index
+            // counter so create() cannot hand them out again; pool entities must be live.
+            const uint64_t indexLimit = std::min<uint64_t>(header->indexCounter, header->generationCount);
+            std::vector<uint32_t> aliveSlots(header->generationCount, Registry::NO_SLOT);
+            for (uint32_t i = 0; i < header->aliveCount; ++i) {
+                const tEntity entity = alive[i];
+                if (entity.index() >= indexLimit || generations[entity.index()] != entity.generation() ||
+                    aliveSlots[entity.index()] != Registry::NO_SLOT) {
+                    logError("ECS", "Snapshot restore failed: invalid live entity {}.", entity.index());
+                    return false;
+                }
+                aliveSlots[entity.index()] = i;
+            }
+
+            // Reused as a per-pool "seen" mark, so an entity listed twice in one pool is caught too.
+            std::vector<uint32_t> seenInPool(header->generationCount, UINT32_MAX);
+            for (uint32_t i = 0; i < header->poolCount; ++i) {
+                const auto *entities = at<tEntity>(_blob, records[i].entitiesOffset, records[i].count);
+                for (uint32_t j = 0; j < records[i].count; ++j) {
+                    const tEntity entity = entities[j];
+                    if (entity.index() >= header->generationCount || aliveSlots[entity.index()] == Registry::NO_SLOT ||
+                        generations[entity.index()] != entity.generation() || seenInPool[entity.index()] == i) {
+                        logError("ECS", "Snapshot restore failed: pool {:016x} holds invalid entity {}.",
+                                 records[i].typeHash, entity.index());
+                        return false;
+                    }
+                    seenInPool[entity.index()] = i;
+                }
+            }
+
+            _registry.m_indexCounter.store(header->indexCounter, std::memory_order_relaxed);
+            _registry.m_generations.assign(generations, generations + header->generationCount);
+            _registry.m_alive.assign(alive, alive + header->aliveCount);
+            _registry.m_aliveSlots = std::move(aliveSlots);
+            _registry.rebuildFreeList();
+
+            for (const auto &pool: _registry.m_componentPools) {
+                if (!pool) continue;
+
+                const auto *end = records + header->poolCount;
+                const auto *record = std::find_if(records, end, [&](const sPoolRecord &_record) {
+                    return _record.typeHash == pool->typeHash();
+                });
+
+                if (record == end) {
+                    pool->clear();
+                } else if (record->stride != pool->snapshotStride()) {
+                    logWarning("ECS", "Snapshot pool {:016x} has stride {}, expected {}; cleared.", record->typeHash,
+                               record->stride, pool->snapshotStride());
+                    pool->clear();
+                } else {
+                    pool->readSnapshot(_blob.data() + record->componentsOffset,
+                                       reinterpret_cast<const tEntity *>(_blob.data() + record->entitiesOffset),
+                                       record->count);
+                }
+            }
+
+            for (uint32_t i = 0; i < header->poolCount; ++i) {
+                const bool known = std::ranges::any_of(_registry.m_componentPools, [&](const auto &_pool) {
+                    return _pool && _pool->typeHash() == records[i].typeHash;
+                });
+                if (!known) {
+                    logWarning("ECS", "Snapshot pool {:016x} has no registered component type, skipped.",
+                               records[i].typeHash);
+                }
+            }
+            return true;
+        }
+
+        static bool save(const Registry &_registry, const std::filesystem::path &_path) {
+            const auto blob = capture(_registry);
+
+            std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(blob.data()), static_cast<std::streamsize>(blob.size()));
+            if (!file) {
+                logError("ECS", "Failed to write snapshot: {}", _path.string());
+                return false;
+            }
+            return true;
+        }
+
+        static bool load(Registry &_registry, const std::filesystem::path &_path) {
+            const MappedFile file(_path);
+            if (!file.isValid()) {
+                logError("ECS", "Failed to map snapshot: {}", _path.string());
+                return false;
+            }
+            return restore(_registry, file.bytes());
+        }
+    };
+}
@@ -0,0 +1,350 @@
+module;
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "hlsl++.h"
+export module opn.ECS:Spatial;
+import :Registry;
+import :Hierarchy;
+import :tEntity;
+import opn.ECS.Components;
+
+export namespace opn {
+    namespace components {
+        /**
+         * @brief World-space bounding sphere radius around the entity's position, used by spatial
+         * queries. Entities without it are indexed as points.
+         */
+        struct Bounds {
+            float radius = 0.0f;
+
+            static constexpr std::string_view SnapshotName = "opn.Bounds";
+        };
+    }
+
+    /**
+     * @brief Six inward-facing planes, xyz is the normal and w the offset; a point p is inside when
+     * dot(normal, p) + w >= 0 for every plane.
+     */
+    struct sFrustum {
+        std::array<hlslpp::float4, 6> planes;
+
+        /**
+         * @brief Extracts the planes of a row-vector view-projection (clip = mul(p, M)) with a 0..1 depth range.
+         */
+        [[nodiscard]] static sFrustum fromViewProjection(const hlslpp::float4x4 &_viewProjection) {
+            float m[16];
+            hlslpp::store(m, _viewProjection);
+            const auto column = [&](const int _c) {
+                return hlslpp::float4(m[_c], m[4 + _c], m[8 + _c], m[12 + _c]);
+            };
+
+            const auto x = column(0), y = column(1), z = column(2), w = column(3);
+            return {{w + x, w - x, w + y, w - y, z, w - z}};
+        }
+    };
+
+    namespace systems {
+        /**
+         * @brief Uniform hash grid over entity positions, kept current from the Transform, Hierarchy
+         * and Bounds change logs.
+         *
+         * An entity sits in the cell holding its centre; queries widen their cell range by the largest
+         * radius indexed so far, so no entry is ever stored twice. update() applies everything changed
+         * since the previous call as one batch. Hierarchy nodes are indexed at their world position,
+         * so update() has to run after the hierarchy pass. Query results go to an internal buffer, the
+         * returned span stays valid until the next query.
+         */
+        class SpatialIndex final {
+            static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+            // Cell coordinates are clamped to 21 bits each so they pack into one key; content beyond
+            // about a million cells from the origin shares the border cells.
+            static constexpr int32_t CELL_LIMIT = (1 << 20) - 1;
+
+            struct sItem {
+                float x, y, z, radius;
+                tEntity entity;
+            };
+
+            struct sCell {
+                int32_t x = 0, y = 0, z = 0;
+                std::vector<sItem> items;
+            };
+
+            struct sLocation {
+                uint32_t cell = NONE;
+                uint32_t slot = 0;
+            };
+
+            Registry *m_registry = nullptr;
+            float m_cellSize = 16.0f;
+            float m_invCellSize = 1.0f / 16.0f;
+            float m_maxRadius = 0.0f;
+            uint32_t m_lastTick = 0;
+
+            std::vector<sCell> m_cells;
+            std::vector<uint32_t> m_freeCells;
+            std::unordered_map<uint64_t, uint32_t> m_cellLookup;
+
+            // Indexed by entity index.
+            std::vector<sLocation> m_locations;
+
+            // Scratch reused across updates and queries.
+            std::vector<tEntity> m_pending;
+            std::vector<tEntity> m_results;
+
+        public:
+            explicit SpatialIndex(Registry &_registry, const float _cellSize = 16.0f)
+                : m_registry(&_registry), m_cellSize(_cellSize), m_invCellSize(1.0f / _cellSize) {}
+
+            void update() {
+                m_pending.clear();
+                const auto collect = [this](const tEntity _entity, const auto &...) { m_pending.push_back(_entity); };
+
+                m_registry->forEachChanged<components::Transform>(m_lastTick, collect);
+                m_registry->forEachChanged<components::Hierarchy>(m_lastTick, collect);
+                m_registry->forEachChanged<components::Bounds>(m_lastTick, collect);
+                m_registry->forEachRemoved<components::Transform>(m_lastTick, collect);
+                m_registry->forEachRemoved<components::Hierarchy>(m_lastTick, collect);
+                m_registry->forEachRemoved<components::Bounds>(m_lastTick, collect);
+                m_lastTick = m_registry->advanceTick();
+
+                std::ranges::sort(m_pending, {}, &tEntity::id);
+                const auto duplicates = std::ranges::unique(m_pending);
+                m_pending.erase(duplicates.begin(), duplicates.end());
+
+                const auto *transforms = m_registry->findPool<components::Transform>();
+                const auto *nodes = m_registry->findPool<components::Hierarchy>();
+                const auto *bounds = m_registry->findPool<components::Bounds>();
+
+                for (const tEntity entity: m_pending) {
+                    const auto *transform = transforms && m_registry->isValid(entity) ? transforms->get(entity) : nullptr;
+                    if (!transform) {
+                        erase(entity);
+                        continue;
+                    }
+
+                    float position[3];
+                    if (const auto *node = nodes ? nodes->get(entity) : nullptr) {
+                        const hlslpp::float4 origin = hlslpp::mul(hlslpp::float4(0.0f, 0.0f, 0.0f, 1.0f), node->world);
+                        hlslpp::store(position, hlslpp::float3(origin.xyz));
+                    } else {
+                        hlslpp::store(position, transform->position);
+                    }
+
+                    const auto *sphere = bounds ? bounds->get(entity) : nullptr;
+                    place({position[0], position[1], position[2], sphere ? sphere->radius : 0.0f, entity});
+                }
+            }
+
+            [[nodiscard]] uint32_t lastTick() const noexcept { return m_lastTick; }
+
+            [[nodiscard]] size_t size() const noexcept {
+                size_t count = 0;
+                for (const auto &cell: m_cells) count += cell.items.size();
+                return count;
+            }
+
+            /**
+             * @brief Entities whose bounds overlap the box [_min, _max].
+             */
+            std::span<const tEntity> queryAABB(const hlslpp::float3 &_min, const hlslpp::float3 &_max) {
+                float lo[3], hi[3];
+                hlslpp::store(lo, _min);
+                hlslpp::store(hi, _max);
+
+                m_results.clear();
+                forEachCellInBox(lo, hi, [&](const sCell &_cell) {
+                    for (const auto &item: _cell.items) {
+                        const float dx = std::max({lo[0] - item.x, 0.0f, item.x - hi[0]});
+                        const float dy = std::max({lo[1] - item.y, 0.0f, item.y - hi[1]});
+                        const float dz = std::max({lo[2] - item.z, 0.0f, item.z - hi[2]});
+                        if (dx * dx + dy * dy + dz * dz <= item.radius * item.radius) m_results.push_back(item.entity);
+                    }
+                });
+                return m_results;
+            }
+
+            /**
+             * @brief Entities whose bounds overlap the sphere around _center.
+             */
+            std::span<const tEntity> querySphere(const hlslpp::float3 &_center, const float _radius) {
+                float c[3];
+                hlslpp::store(c, _center);
+                const float lo[3] = {c[0] - _radius, c[1] - _radius, c[2] - _radius};
+                const float hi[3] = {c[0] + _radius, c[1] + _radius, c[2] + _radius};
+
+                m_results.clear();
+                forEachCellInBox(lo, hi, [&](const sCell &_cell) {
+                    for (const auto &item: _cell.items) {
+                        const float dx = item.x - c[0], dy = item.y - c[1], dz = item.z - c[2];
+                        const float reach = _radius + item.radius;
+                        if (dx * dx + dy * dy + dz * dz <= reach * reach) m_results.push_back(item.entity);
+                    }
+                });
+                return m_results;
+            }
+
+            /**
+             * @brief Entities whose bounds are at least partly inside _frustum. Whole cells are culled
+             * first, cells entirely inside skip the per-entity plane tests.
+             */
+            std::span<const tEntity> queryFrustum(const sFrustum &_frustum) {
+                float planes[6][4];
+                for (size_t i = 0; i < 6; ++i) hlslpp::store(planes[i], _frustum.planes[i]);
+
+                m_results.clear();
+                for (const auto &cell: m_cells) {
+                    if (cell.items.empty()) continue;
+
+                    // Cell box grown by the largest radius, so it contains every entry's sphere.
+                    const float lo[3] = {
+                        static_cast<float>(cell.x) * m_cellSize - m_maxRadius,
+                        static_cast<float>(cell.y) * m_cellSize - m_maxRadius,
+                        static_cast<float>(cell.z) * m_cellSize - m_maxRadius
+                    };
+                    const float extent = m_cellSize + 2.0f * m_maxRadius;
+
+                    bool outside = false, inside = true;
+                    for (const auto &plane: planes) {
+                        float far = plane[3], near = plane[3];
+                        for (int a = 0; a < 3; ++a) {
+                            const float low = plane[a] * lo[a], high = plane[a] * (lo[a] + extent);
+                            far += std::max(low, high);
+                            near += std::min(low, high);
+                        }
+                        if (far < 0.0f) {
+                            outside = true;
+                            break;
+                        }
+                        inside &= near >= 0.0f;
+                    }
+                    if (outside) continue;
+
+                    for (const auto &item: cell.items) {
+                        bool visible = true;
+                        for (size_t p = 0; p < 6 && visible && !inside; ++p) {
+                            const auto &plane = planes[p];
+                            visible = plane[0] * item.x + plane[1] * item.y + plane[2] * item.z + plane[3] >= -item.radius;
+                        }
+                        if (visible) m_results.push_back(item.entity);
+                    }
+                }
+                return m_results;
+            }
+
+        private:
+            [[nodiscard]] int32_t cellCoord(const float _value) const noexcept {
+                return static_cast<int32_t>(std::clamp(std::floor(_value * m_invCellSize),
+                                                       static_cast<float>(-CELL_LIMIT), static_cast<float>(CELL_LIMIT)));
+            }
+
+            static uint64_t cellKey(const int32_t _x, const int32_t _y, const int32_t _z) noexcept {
+                constexpr uint64_t MASK = (uint64_t{1} << 21) - 1;
+                return (static_cast<uint64_t>(_x) & MASK) << 42 | (static_cast<uint64_t>(_y) & MASK) << 21 |
+                       (static_cast<uint64_t>(_z) & MASK);
+            }
+
+            /**
+             * @brief Calls _func(cell) for every occupied cell that may hold an entry overlapping the
+             * box. Walks the occupied cells directly when that is cheaper than the covered range.
+             */
+            template<typename Func>
+            void forEachCellInBox(const float (&_lo)[3], const float (&_hi)[3], Func &&_func) const {
+                const int32_t x0 = cellCoord(_lo[0] - m_maxRadius), x1 = cellCoord(_hi[0] + m_maxRadius);
+                const int32_t y0 = cellCoord(_lo[1] - m_maxRadius), y1 = cellCoord(_hi[1] + m_maxRadius);
+                const int32_t z0 = cellCoord(_lo[2] - m_maxRadius), z1 = cellCoord(_hi[2] + m_maxRadius);
+                if (x0 > x1 || y0 > y1 || z0 > z1) return;
+
+                const uint64_t covered = uint64_t(x1 - x0 + 1) * uint64_t(y1 - y0 + 1) * uint64_t(z1 - z0 + 1);
+                if (covered > m_cellLookup.size()) {
+                    for (const auto &cell: m_cells) {
+                        if (!cell.items.empty() && cell.x >= x0 && cell.x <= x1 && cell.y >= y0 && cell.y <= y1 &&
+                            cell.z >= z0 && cell.z <= z1) {
+                            _func(cell);
+                        }
+                    }
+                    return;
+                }
+
+                for (int32_t x = x0; x <= x1; ++x) {
+                    for (int32_t y = y0; y <= y1; ++y) {
+                        for (int32_t z = z0; z <= z1; ++z) {
+                            if (const auto it = m_cellLookup.find(cellKey(x, y, z)); it != m_cellLookup.end()) {
+                                _func(m_cells[it->second]);
+                            }
+                        }
+                    }
+                }
+            }
+
+            void place(const sItem &_item) {
+                const uint32_t index = _item.entity.index();
+                if (index >= m_locations.size()) m_locations.resize(size_t{index} + 1024);
+                m_maxRadius = std::max(m_maxRadius, _item.radius);
+
+                const int32_t x = cellCoord(_item.x), y = cellCoord(_item.y), z = cellCoord(_item.z);
+                auto &location = m_locations[index];
+                if (location.cell != NONE) {
+                    auto &cell = m_cells[location.cell];
+                    if (cell.x == x && cell.y == y && cell.z == z) {
+                        cell.items[location.slot] = _item;
+                        return;
+                    }
+                    // Also evicts a stale handle whose removal has not been seen yet.
+                    erase(cell.items[location.slot].entity);
+                }
+
+                const uint64_t key = cellKey(x, y, z);
+                auto [it, inserted] = m_cellLookup.try_emplace(key, NONE);
+                if (inserted) {
+                    if (m_freeCells.empty()) {
+                        it->second = static_cast<uint32_t>(m_cells.size());
+                        m_cells.emplace_back();
+                    } else {
+                        it->second = m_freeCells.back();
+                        m_freeCells.pop_back();
+                    }
+                    auto &cell = m_cells[it->second];
+                    cell.x = x;
+                    cell.y = y;
+                    cell.z = z;
+                }
+
+                auto &cell = m_cells[it->second];
+                location = {it->second, static_cast<uint32_t>(cell.items.size())};
+                cell.items.push_back(_item);
+            }
+
+            void erase(const tEntity _entity) {
+                const uint32_t index = _entity.index();
+                if (index >= m_locations.size()) return;
+
+                auto &location = m_locations[index];
+                if (location.cell == NONE) return;
+
+                auto &cell = m_cells[location.cell];
+                if (cell.items[location.slot].entity != _entity) return;
+
+                if (location.slot + 1 != cell.items.size()) {
+                    cell.items[location.slot] = cell.items.back();
+                    m_locations[cell.items[location.slot].entity.index()].slot = location.slot;
+                }
+                cell.items.pop_back();
+
+                if (cell.items.empty()) {
+                    m_cellLookup.erase(cellKey(cell.x, cell.y, cell.z));
+                    m_freeCells.push_back(location.cell);
+                }
+                location = {};
+            }
+        };
+    }
+}
@@ -1,13 +1,16 @@
 module;
-#include <string>
+#include <algorithm>
 #include "hlsl++.h"
 export module opn.ECS:Systems;
 import :Registry;
+import :Hierarchy;
+import :Interpolation;
+import :RenderExtraction;
+import :Spatial;
 import opn.ECS.Components;
 import opn.Utils.Logging;
 import opn.Utils.Locator;
 import opn.System.Service.Rendering;
-import opn.System.Service.ShaderReflection;
 import opn.System.Service.Time;
 
 export namespace opn::systems {
@@ -15,28 +18,53 @@ export namespace opn::systems {
         friend class ECS;
 
         Registry* m_registry = nullptr;
+        TransformHierarchy m_hierarchy;
+        TransformInterpolation m_interpolation;
+        RenderExtraction m_extraction;
+        SpatialIndex m_spatial;
 
     public:
         explicit Systems(Registry& _registry)
-            : m_registry(&_registry) {}
+            : m_registry(&_registry), m_hierarchy(_registry), m_interpolation(_registry),
+              m_extraction(_registry, &m_interpolation), m_spatial(_registry) {}
 
-        void renderMeshes() {
-            auto& backend = Locator::getService<iRenderingService>()->getBackend();
-            const auto* compiler = Locator::getService<ShaderCompiler>();
+        [[nodiscard]] TransformHierarchy& hierarchy() { return m_hierarchy; }
+        [[nodiscard]] SpatialIndex& spatial() { return m_spatial; }
 
-            m_registry->forEach<components::Transform, components::Renderable>(
-                [&](tEntity _entity, const auto& _transform, const auto& _renderable) {
+        void updateHierarchy() {
+            m_hierarchy.update();
+        }
 
-                    std::string shaderPath = "shaders/default.slang";
-                    if (m_registry->hasComponent<components::ShaderOverride>(_entity)) {
-                    }
+        /**
+         * @brief Moves changed entities in the spatial grid, must follow updateHierarchy().
+         */
+        void updateSpatial() {
+            m_spatial.update();
+        }
 
-                    if (const auto reflection = compiler->compile(shaderPath); !reflection) {
-                        opn::logError("ECS", "Failed to compile shader: {}", shaderPath);
-                        return;
-                    }
-                }
-            );
+        /**
+         * @brief Records the worlds this step moved, must follow updateHierarchy().
+         */
+        void updateInterpolation() {
+            m_interpolation.update();
+        }
+
+        /**
+         * @brief Oldest change tick still needed by a system, change logs can be trimmed up to it.
+         */
+        [[nodiscard]] uint32_t oldestTick() const noexcept {
+            return std::min({m_hierarchy.lastTick(), m_spatial.lastTick(), m_interpolation.lastTick()});
+        }
+
+        /**
+         * @brief Extracts this frame's draw list and hands it to the rendering backend in one call.
+         * _alpha blends between the last two fixed steps.
+         */
+        void renderMeshes(const float _alpha) {
+            auto* rendering = Locator::getService<iRenderingService>();
+            if (!rendering) return;
+
+            rendering->getBackend().submitDrawList(m_extraction.extract(_alpha));
         }
 
         void rotateAll(float _deltaTime) {
@@ -0,0 +1,149 @@
+module;
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+export module opn.ECS:World;
+
+import :Registry;
+import :ECB;
+import :Hierarchy;
+import :tEntity;
+
+export namespace opn {
+    /**
+     * @brief Standalone entity world for building content away from the live one, e.g. a streamed
+     * level chunk assembled on a loader thread.
+     *
+     * Writes apply immediately, there is no command buffer. A World is not thread-safe, only one
+     * thread may use it at a time. EntityComponentSystem::mergeWorld() moves its contents into the
+     * live world in bulk and leaves it empty for reuse.
+     */
+    class World final {
+        friend class EntityComponentSystem;
+
+        Registry m_registry;
+
+    public:
+        World() = default;
+
+        World(const World &) = delete;
+
+        World &operator=(const World &) = delete;
+
+        tEntity createEntity() {
+            // No playback here, so destroyed indices are handed back on the next create.
+            m_registry.publishFreeList();
+            const tEntity entity = m_registry.create();
+            m_registry.internal_registerCreate(entity);
+            return entity;
+        }
+
+        void createEntities(const std::span<tEntity> _out) {
+            m_registry.publishFreeList();
+            m_registry.create(_out);
+            m_registry.internal_registerCreate(std::span<const tEntity>(_out));
+        }
+
+        /**
+         * @brief Hands out handles without creating the entities, for commands recorded into an
+         * EntityCommandBuffer; they come alive when it is played back with playback().
+         */
+        void reserveEntities(const std::span<tEntity> _out) {
+            m_registry.publishFreeList();
+            m_registry.create(_out);
+        }
+
+        /**
+         * @brief Applies the commands recorded in _ecb to this world.
+         */
+        void playback(EntityCommandBuffer &_ecb) {
+            _ecb.playback(m_registry);
+        }
+
+        void destroyEntity(const tEntity _entity) {
+            m_registry.internalDestroy(_entity);
+        }
+
+        /**
+         * @return The stored component, nullptr if _entity is not alive in this world.
+         */
+        template<typename T>
+        T *addComponent(const tEntity _entity, T _component) {
+            if (!m_registry.isValid(_entity)) return nullptr;
+            return &m_registry.addComponent(_entity, std::move(_component));
+        }
+
+        /**
+         * @brief Adds one component per entity as a single pool insert, moving out of _components.
+         * Handles not alive in this world are skipped.
+         * @return Number of components added, 0 if the spans differ in length.
+         */
+        template<typename T>
+        size_t addComponents(const std::span<const tEntity> _entities, const std::span<T> _components) {
+            if (_components.size() != _entities.size()) return 0;
+            return m_registry.addComponents(_entities, _components.data());
+        }
+
+        /**
+         * @note Parents must live in the same world; links are rewritten when the world is merged.
+         */
+        void setParent(const tEntity _child, const tEntity _parent) {
+            addComponent(_child, components::Hierarchy{.parent = _parent});
+        }
+
+        template<typename T>
+        void removeComponent(const tEntity _entity) {
+            m_registry.removeComponent<T>(_entity);
+        }
+
+        template<typename T>
+        T *getComponent(const tEntity _entity) {
+            return m_registry.getComponent<T>(_entity);
+        }
+
+        template<typename T>
+        const T *getComponent(const tEntity _entity) const {
+            return m_registry.getComponent<T>(_entity);
+        }
+
+        template<typename T>
+        [[nodiscard]] bool hasComponent(const tEntity _entity) const {
+            return m_registry.hasComponent<T>(_entity);
+        }
+
+        template<typename... Ts, typename Func> requires (sizeof...(Ts) > 0)
+        void forEach(Func &&_func) {
+            m_registry.forEach<Ts...>(std::forward<Func>(_func));
+        }
+
+        /**
+         * @brief Keeps the entities holding every one of Owned packed in matching order, so forEach over
+         * them walks the pools in lock-step.
+         * @return False if one of the pools already belongs to a different group.
+         */
+        template<typename... Owned> requires (sizeof...(Owned) >= 2)
+        bool group() {
+            return m_registry.group<Owned...>() != nullptr;
+        }
+
+        /**
+         * @brief Entities holding T, in the order forEach<T> visits them.
+         */
+        template<typename T> requires (!std::is_empty_v<T>)
+        [[nodiscard]] std::span<const tEntity> entitiesWith() const {
+            const auto *pool = m_registry.findPool<T>();
+            return pool ? std::span<const tEntity>(pool->entities()) : std::span<const tEntity>();
+        }
+
+        [[nodiscard]] size_t getEntityCount() const noexcept {
+            return m_registry.aliveCount();
+        }
+
+        [[nodiscard]] bool isEntityValid(const tEntity _entity) const noexcept {
+            return m_registry.isValid(_entity);
+        }
+    };
+}
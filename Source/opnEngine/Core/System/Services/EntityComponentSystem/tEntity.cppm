@@ -1,29 +1,83 @@
 module;
 #include <cstdint>
+#include <type_traits>
+
+// Handle width and index/generation split are fixed per build, see OPN_ENTITY_BITS in the root CMakeLists.
+#ifndef OPN_ENTITY_BITS
+#define OPN_ENTITY_BITS 32
+#endif
+
+#ifndef OPN_ENTITY_INDEX_BITS
+#if OPN_ENTITY_BITS == 64
+#define OPN_ENTITY_INDEX_BITS 32
+#else
+#define OPN_ENTITY_INDEX_BITS 20
+#endif
+#endif
+
 export module opn.ECS:tEntity;
 
 export namespace opn {
-    struct tEntity {
-        uint32_t id = 0xFFFFFFFF;
+    /**
+     * @brief Bit layout of an entity handle: index in the low IndexBits, generation above it.
+     *
+     * Indices stay 32-bit so pools keep 32-bit dense slots. The all-ones generation is never handed
+     * out; a slot whose generation would reach it is retired instead of recycled, which also keeps
+     * every live handle distinct from the null value.
+     */
+    template<typename Value, uint32_t IndexBits>
+    struct sEntityTraits {
+        static_assert(std::is_unsigned_v<Value>);
+        static_assert(IndexBits > 0 && IndexBits <= 32 && IndexBits < sizeof(Value) * 8);
+
+        using value_type = Value;
+        using index_type = uint32_t;
+        using generation_type = std::conditional_t<(sizeof(Value) * 8 - IndexBits > 32), uint64_t, uint32_t>;
+
+        static constexpr uint32_t INDEX_BITS = IndexBits;
+        static constexpr uint32_t GENERATION_BITS = sizeof(Value) * 8 - IndexBits;
+        static constexpr value_type INDEX_MASK = (value_type{1} << IndexBits) - 1;
+        static constexpr value_type GENERATION_MASK = ~value_type{0} >> IndexBits;
+        static constexpr value_type NULL_VALUE = ~value_type{0};
+
+        static constexpr generation_type RETIRED_GENERATION = static_cast<generation_type>(GENERATION_MASK);
+    };
+
+    template<typename Traits>
+    struct basic_entity {
+        using traits_type = Traits;
+        using value_type = typename Traits::value_type;
+        using index_type = typename Traits::index_type;
+        using generation_type = typename Traits::generation_type;
+
+        value_type id = Traits::NULL_VALUE;
 
-        static constexpr uint32_t INDEX_MASK = 0x000FFFFF;
-        static constexpr uint32_t GEN_MASK   = 0xFFF00000;
-        static constexpr uint32_t GEN_SHIFT  = 20;
+        static constexpr index_type MAX_INDEX = static_cast<index_type>(Traits::INDEX_MASK);
+        static constexpr generation_type RETIRED_GENERATION = Traits::RETIRED_GENERATION;
 
-        [[nodiscard]] uint32_t index() const noexcept {
-            return id & INDEX_MASK;
+        [[nodiscard]] constexpr index_type index() const noexcept {
+            return static_cast<index_type>(id & Traits::INDEX_MASK);
         }
-        [[nodiscard]] uint32_t generation() const noexcept {
-            return (id & GEN_MASK) >> GEN_SHIFT;
+
+        [[nodiscard]] constexpr generation_type generation() const noexcept {
+            return static_cast<generation_type>(id >> Traits::INDEX_BITS);
         }
 
-        static tEntity make(const uint32_t _index, const uint32_t _generation) noexcept {
-            return { _index | (_generation << GEN_SHIFT) };
+        static constexpr basic_entity make(const index_type _index, const generation_type _generation) noexcept {
+            return {static_cast<value_type>(_index) |
+                    (static_cast<value_type>(_generation) & Traits::GENERATION_MASK) << Traits::INDEX_BITS};
         }
 
-        bool operator==(const tEntity &other) const noexcept = default;
-        [[nodiscard]] bool is_null() const noexcept { return id == 0xFFFFFFFF; }
+        constexpr bool operator==(const basic_entity &other) const noexcept = default;
+        [[nodiscard]] constexpr bool is_null() const noexcept { return id == Traits::NULL_VALUE; }
     };
 
-    constexpr tEntity NULL_ENTITY = { 0xFFFFFFFF };
+    using tEntityTraits = sEntityTraits<std::conditional_t<OPN_ENTITY_BITS == 64, uint64_t, uint32_t>,
+                                        OPN_ENTITY_INDEX_BITS>;
+    using tEntity = basic_entity<tEntityTraits>;
+
+    static_assert(OPN_ENTITY_BITS == 32 || OPN_ENTITY_BITS == 64, "OPN_ENTITY_BITS must be 32 or 64");
+    static_assert(sizeof(tEntity) == OPN_ENTITY_BITS / 8);
+
+    constexpr tEntity NULL_ENTITY = {tEntityTraits::NULL_VALUE};
 }
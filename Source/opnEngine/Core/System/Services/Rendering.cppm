@@ -23,6 +23,13 @@ export namespace opn {
         Backend m_Backend{};
 
     public:
+        // Instance creation in init() needs no window and may overlap other services. Binding creates
+        // the surface and installs ImGui's GLFW hooks, so postInit() stays on the main thread, as
+        // does the per-frame ImGui and present work.
+        static constexpr eMainThread RequiresMainThread = eMainThread::PostInit | eMainThread::Update;
+        // Draws what the simulation phases produced this frame.
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::PostFrame;
+
         RenderBackend &getBackend() override { return m_Backend; }
 
     protected:
@@ -19,6 +19,9 @@ export namespace opn {
         ComPtr<slang::IGlobalSession> m_globalSession;
         mutable std::unordered_map<std::string, sShaderReflection> m_reflectionCache;
 
+    public:
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::None;
+
     protected:
         void onInit() override {
             if (SLANG_FAILED(slang::createGlobalSession(m_globalSession.writeRef())))
@@ -1,7 +1,11 @@
 module;
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
 
 export module opn.System.Service.Time;
 
@@ -9,6 +13,15 @@ import opn.System.ServiceInterface;
 import opn.Utils.Exceptions;
 
 export namespace opn {
+    enum class eFramePacing : uint8_t {
+        // Frames run back to back.
+        Uncapped,
+        // Time holds each frame to the target frame rate.
+        Limited,
+        // Presentation blocks on the display refresh, the renderer uses a FIFO swapchain.
+        VSync
+    };
+
     class Time final : public Service<Time> {
         using Clock = std::chrono::high_resolution_clock;
         using TimePoint = std::chrono::high_resolution_clock::time_point;
@@ -29,11 +42,28 @@ export namespace opn {
         double m_fixedDeltaTime{1.0 / 60.0};
         double m_accumulator{0.0};
 
+        uint32_t m_maxStepsPerFrame{5};
+        uint32_t m_stepsThisFrame{0};
+        uint64_t m_droppedSteps{0};
+
+        eFramePacing m_pacing{eFramePacing::VSync};
+        double m_targetFrameRate{60.0};
+        double m_idleFrameRate{20.0};
+        TimePoint m_frameDeadline{};
+        // How late sleeps wake up, smoothed; the last stretch before a deadline is spun instead.
+        Duration m_oversleep{0.001};
+        double m_pacingWait{0.0};
+
+        // Spin bounds: below the floor sleep is precise enough, above the cap spinning costs more than it saves.
+        constexpr static Duration MIN_SPIN{0.0002};
+        constexpr static Duration MAX_SPIN{0.002};
+
     protected:
         void onInit() override {
             if (!m_initialized.exchange(true, std::memory_order::relaxed)) {
                 m_startTime = Clock::now();
                 m_lastFrameTime = m_startTime;
+                m_frameDeadline = m_startTime;
                 m_accumulator = 0.0;
             }
         }
@@ -46,7 +76,14 @@ export namespace opn {
         }
 
     public:
-        void onUpdate(float /*_deltaTime*/) override {
+        // Advanced explicitly by the engine loop through beginFrame(), before any phase runs.
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::None;
+
+        /**
+         * @brief Measures the frame delta and banks it for fixed steps. Called once at the top of
+         * each frame so every phase sees this frame's delta.
+         */
+        void beginFrame() {
             const auto currentTime = Clock::now();
             m_deltaTimeReal = std::chrono::duration<double>(currentTime - m_lastFrameTime).count();
             m_lastFrameTime = currentTime;
@@ -54,30 +91,120 @@ export namespace opn {
             m_deltaTimeGame = m_paused ? 0.0 : m_deltaTimeReal * m_timeScale;
 
             m_accumulator += m_deltaTimeGame;
+            m_stepsThisFrame = 0;
+
+            // A frame that owes more steps than the budget drops the rest, so a slow frame cannot make
+            // the next one slower still. The simulation runs behind real time instead.
+            const double budget = m_maxStepsPerFrame * m_fixedDeltaTime;
+            if (m_accumulator > budget) {
+                m_droppedSteps += static_cast<uint64_t>(std::floor((m_accumulator - budget) / m_fixedDeltaTime));
+                m_accumulator = budget;
+            }
         }
 
+        /**
+         * @brief Starts the frame clock over from now, dropping any time banked for fixed steps.
+         * Called right before the first frame so init and post-init do not count as frame time.
+         */
+        void resetFrameClock() {
+            m_lastFrameTime = Clock::now();
+            m_frameDeadline = m_lastFrameTime;
+            m_accumulator = 0.0;
+            m_stepsThisFrame = 0;
+        }
+
+        /**
+         * @brief True while another fixed step is due this frame, consuming it. At most
+         * getMaxStepsPerFrame() per frame.
+         */
         bool checkPhysicsStep() {
-            if (m_accumulator >= m_fixedDeltaTime) {
+            if (m_stepsThisFrame < m_maxStepsPerFrame && m_accumulator >= m_fixedDeltaTime) {
                 m_accumulator -= m_fixedDeltaTime;
+                ++m_stepsThisFrame;
                 return true;
             }
             return false;
         }
 
+        /**
+         * @brief Holds the frame until its pacing deadline, called once the frame's work is done.
+         * _idle paces at the idle frame rate whatever the mode, e.g. while the window is minimised
+         * and nothing presents.
+         */
+        void endFrame(const bool _idle) {
+            const double rate = _idle ? m_idleFrameRate
+                                : m_pacing == eFramePacing::Limited ? m_targetFrameRate
+                                : 0.0;
+            const auto now = Clock::now();
+            if (rate <= 0.0) {
+                m_frameDeadline = now;
+                m_pacingWait = 0.0;
+                return;
+            }
+
+            // Deadlines advance by whole periods so the average rate stays exact despite jitter.
+            const auto period = std::chrono::duration_cast<Clock::duration>(Duration(1.0 / rate));
+            m_frameDeadline += period;
+            // After a hitch or a rate change start over from now rather than rushing or stalling.
+            if (m_frameDeadline + period < now || m_frameDeadline > now + period) {
+                m_frameDeadline = now + period;
+            }
+
+            waitUntil(m_frameDeadline);
+            m_pacingWait = std::chrono::duration<double>(Clock::now() - now).count();
+        }
+
         [[nodiscard]] double getDeltaTime() const noexcept { return m_deltaTimeGame; }
         [[nodiscard]] double getRealDeltaTime() const noexcept { return m_deltaTimeReal; }
         [[nodiscard]] double getFixedDeltaTime() const noexcept { return m_fixedDeltaTime; }
 
+        /**
+         * @brief How far the frame is between the last fixed step and the next, in [0, 1]. The ECS
+         * draws moved entities between their previous and current step by it.
+         */
         [[nodiscard]] double getPhysicsInterpolationFactor() const {
-            return m_accumulator / m_fixedDeltaTime;
+            return std::clamp(m_accumulator / m_fixedDeltaTime, 0.0, 1.0);
         }
 
+        [[nodiscard]] uint32_t getStepsThisFrame() const noexcept { return m_stepsThisFrame; }
+        [[nodiscard]] uint32_t getMaxStepsPerFrame() const noexcept { return m_maxStepsPerFrame; }
+        // Fixed steps skipped by the per-frame clamp since start.
+        [[nodiscard]] uint64_t getDroppedSteps() const noexcept { return m_droppedSteps; }
+
         void setPaused(const bool _paused) noexcept { m_paused = _paused; }
         void setTimeScale(const double _scale) noexcept { m_timeScale = _scale; }
 
+        [[nodiscard]] eFramePacing getFramePacing() const noexcept { return m_pacing; }
+        [[nodiscard]] double getTargetFrameRate() const noexcept { return m_targetFrameRate; }
+        // Seconds endFrame() held the last frame, i.e. CPU time handed back.
+        [[nodiscard]] double getPacingWait() const noexcept { return m_pacingWait; }
+
+        void setFramePacing(const eFramePacing _pacing) noexcept { m_pacing = _pacing; }
+        void setTargetFrameRate(const double _fps) noexcept { m_targetFrameRate = _fps; }
+        // Rate while idle, e.g. minimised. 0 leaves idle frames unpaced.
+        void setIdleFrameRate(const double _fps) noexcept { m_idleFrameRate = _fps; }
+
+        void setMaxStepsPerFrame(const uint32_t _steps) noexcept { m_maxStepsPerFrame = std::max(_steps, 1u); }
+
         void setPhysicsRate(const double _hz) noexcept {
             m_physicsRate = _hz;
             m_fixedDeltaTime = 1.0 / _hz;
         }
+
+    private:
+        /**
+         * @brief Sleeps until shortly before _deadline, then spins the rest. OS sleeps overshoot by
+         * anything from microseconds to a scheduler tick, so the spin margin tracks how late they wake.
+         */
+        void waitUntil(const TimePoint _deadline) {
+            const auto margin = std::clamp(m_oversleep * 1.5, MIN_SPIN, MAX_SPIN);
+            const auto wake = _deadline - std::chrono::duration_cast<Clock::duration>(margin);
+            if (Clock::now() < wake) {
+                std::this_thread::sleep_until(wake);
+                const Duration late = Clock::now() - wake;
+                m_oversleep = m_oversleep * 0.875 + late * 0.125;
+            }
+            while (Clock::now() < _deadline) std::this_thread::yield();
+        }
     };
 };
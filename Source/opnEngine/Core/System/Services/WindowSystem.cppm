@@ -18,6 +18,11 @@ namespace opn {
         bool m_framebufferResized = false;
 
     public:
+        // GLFW init, window creation and callback registration are main-thread only.
+        static constexpr eMainThread RequiresMainThread = eMainThread::All;
+        // Events are pumped by the engine loop itself, nothing to do per frame.
+        static constexpr eUpdatePhase UpdatePhase = eUpdatePhase::None;
+
         [[nodiscard]] bool shouldClose() const {
             return m_window && glfwWindowShouldClose(m_window);
         }
@@ -37,6 +42,10 @@ namespace opn {
         [[nodiscard]] int getWidth() const { return m_width; }
         [[nodiscard]] int getHeight() const { return m_height; }
         [[nodiscard]] bool wasResized() const { return m_framebufferResized; }
+        // Nothing is visible to draw into, the engine loop drops to its idle frame rate.
+        [[nodiscard]] bool isMinimised() const {
+            return m_window && (glfwGetWindowAttrib(m_window, GLFW_ICONIFIED) || m_width == 0 || m_height == 0);
+        }
         void resetResizeFlag() { m_framebufferResized = false; }
 
         [[nodiscard]] VkSurfaceKHR createSurface(VkInstance _instance) const override {
@@ -1,4 +1,5 @@
 module;
+#include <cstddef>
 #include <type_traits>
 export module opn.System.SystemTypeList;
 
@@ -14,8 +15,24 @@ export namespace opn {
             return sizeof...(Types);
         }
 
+        /**
+         * @brief Position of T in the list, size() if absent.
+         */
+        template<typename T>
+        static constexpr std::size_t indexOf() {
+            std::size_t index = 0;
+            (void) ((std::is_same_v<T, Types> || (++index, false)) || ...);
+            return index;
+        }
+
+        /**
+         * @brief Into<Types...>, e.g. a std::tuple holding one entry per listed type.
+         */
+        template<template<typename...> typename Into>
+        using apply = Into<Types...>;
+
         template<typename Func>
-        static void forEach(Func &&_func) {
+        static constexpr void forEach(Func &&_func) {
             (_func(std::type_identity<Types>{}), ...);
         }
     };
@@ -1,5 +1,6 @@
 module;
 #include <concepts>
+#include <cstdint>
 #include <typeindex>
 
 export module opn.System.ServiceInterface;
@@ -25,12 +26,52 @@ namespace opn {
         }
     };
 
+    /**
+     * @brief Lifecycle phases a service has to run on the main thread, e.g. GLFW window and callback setup.
+     *
+     * Declared by a service as `static constexpr eMainThread RequiresMainThread = ...;`. Phases not
+     * listed may run on a job worker, concurrently with other services of the same dependency level.
+     */
+    export enum class eMainThread : uint8_t {
+        None = 0,
+        Init = 1 << 0,
+        PostInit = 1 << 1,
+        Update = 1 << 2,
+        All = Init | PostInit | Update
+    };
+
+    export constexpr eMainThread operator|(const eMainThread _lhs, const eMainThread _rhs) noexcept {
+        return static_cast<eMainThread>(static_cast<uint8_t>(_lhs) | static_cast<uint8_t>(_rhs));
+    }
+
+    /**
+     * @brief Where in the frame a service's update() runs, declared as
+     * `static constexpr eUpdatePhase UpdatePhase = ...;`. Defaults to Variable.
+     *
+     * FixedStep runs zero or more times per frame with the fixed delta, up to Time's per-frame step
+     * limit; the others run once per frame.
+     * Services sharing a phase may update concurrently unless one lists the other in
+     * `using Conflicts = SystemTypeList<...>;`. An optional `static constexpr float UpdateRate`
+     * (Hz) throttles a non-fixed service, which then receives the time since its last update.
+     * Services with nothing to do per frame declare None and are never called.
+     */
+    export enum class eUpdatePhase : uint8_t {
+        PreFrame,
+        FixedStep,
+        Variable,
+        PostFrame,
+        None
+    };
+
     export template<typename T>
     concept IsService = std::derived_from<T, iService>;
 
     export template<typename T, IsService Base = iService>
     class Service : public Base {
     public:
+        // Interface the service can also be looked up by through the Locator, e.g. iRenderingService.
+        using InterfaceType = Base;
+
         static bool isActive() { return s_instance != nullptr; }
 
         void init() final {
@@ -1,45 +1,49 @@
 module;
 
 #include <atomic>
-#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <format>
-#include <iostream>
-#include <mutex>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
 #include <source_location>
+#include <string>
 #include <string_view>
 
+#include "Logging/LogLevels.h"
+
+// Deferred formatting is opt-in per build, see OPN_LOG_DEFERRED in the root CMakeLists.
+#ifndef OPN_LOG_DEFERRED
+#define OPN_LOG_DEFERRED 0
+#endif
+
+// Calls below this level compile to nothing, see OPN_LOG_MIN_LEVEL in the root CMakeLists.
+// Release builds keep Debug so it can still be switched on at runtime.
+#ifndef OPN_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define OPN_LOG_MIN_LEVEL 1
+#else
+#define OPN_LOG_MIN_LEVEL 0
+#endif
+#endif
+
 export module opn.Utils.Logging;
 
-// TODO Add colours to logger for different levels
-
-#define OPN_COL_RESET       "\x1b[0m"
-#define OPN_COL_TIME        "\x1b[38;5;250m"
-#define OPN_COL_CTX         "\x1b[34m"
-#define OPN_COL_BRACKET     "\x1b[37m"
-
-#define OPN_COL_PINK        "\x1b[95m"
-#define OPN_COL_CYAN        "\x1b[36m"
-#define OPN_COL_WHITE       "\x1b[37m"
-#define OPN_COL_YELLOW      "\x1b[33m"
-#define OPN_COL_ORANGE      "\x1b[38;5;208m"
-#define OPN_COL_BOLD_RED    "\x1b[1;31m"
-
-// Defines all forms of logging code will automatically
-// generate new levels if added to this X macro list.
-#define LOG_LEVELS                                   \
-    X(Trace,    "TRACE", 0, false, OPN_COL_PINK)     \
-    X(Debug,    "DEBUG", 1, false, OPN_COL_CYAN)     \
-    X(Info,     "INFO",  2, false, OPN_COL_WHITE)    \
-    X(Warning,  "WARN",  3, true,  OPN_COL_YELLOW)   \
-    X(Error,    "ERROR", 4, true,  OPN_COL_ORANGE)   \
-    X(Critical, "CRIT",  5, true,  OPN_COL_BOLD_RED)
+export import :Record;
+export import :Backend;
+export import :Deferred;
+export import :Filter;
+export import :Sinks;
 
 export namespace opn {
-    enum class eLogLevel : int8_t {
-#define X(name, str, val, showLoc, col) name = val,
-        LOG_LEVELS
-#undef X
-    };
+    // When set, calls whose arguments are all deferrable only copy them; the writer thread formats.
+    constexpr bool LOG_DEFERRED = OPN_LOG_DEFERRED != 0;
+
+    constexpr auto LOG_MIN_LEVEL = static_cast<eLogLevel>(OPN_LOG_MIN_LEVEL);
 
     /**
      * @class Logger
@@ -53,12 +57,25 @@ export namespace opn {
     public:
         struct Context {
             std::string_view category;
+            uint32_t categoryId;
             std::source_location location;
 
-            Context(const char* _category, const std::source_location _location = std::source_location::current())
-                : category(_category), location(_location) {}
+            // Literal categories, the common case, are hashed at compile time.
+            template<size_t N>
+            consteval Context(const char (&_category)[N], const std::source_location _location = std::source_location::current())
+                : category(_category, N - 1), categoryId(logCategoryId(category)), location(_location) {}
             Context(const std::string_view _category, const std::source_location _location = std::source_location::current())
-                : category(_category), location(_location) {}
+                : category(_category), categoryId(logCategoryId(_category)), location(_location) {}
+
+            // Runtime names, hashed per call. Writable buffers match here rather than the consteval
+            // overload, and the pointer form loses to it for literals, which are arrays.
+            template<size_t N>
+            Context(char (&_category)[N], const std::source_location _location = std::source_location::current())
+                : Context(std::string_view(_category), _location) {}
+
+            template<typename T> requires std::same_as<T, const char *> || std::same_as<T, char *>
+            Context(const T _category, const std::source_location _location = std::source_location::current())
+                : Context(std::string_view(_category), _location) {}
         };
 
         static void setLevel(const eLogLevel &_level) noexcept {
@@ -69,68 +86,148 @@ export namespace opn {
             return static_cast<eLogLevel>(min_level.load(std::memory_order_relaxed));
         }
 
+        /**
+         * @brief Overrides the level for one category, e.g. Trace for "VulkanBackend" while the rest
+         * stays at Info. Levels below LOG_MIN_LEVEL stay compiled out regardless.
+         * @return False once the filter table is full.
+         */
+        static bool setCategoryLevel(const std::string_view _category, const eLogLevel _level) noexcept {
+            return detail::CategoryFilters::set(logCategoryId(_category), _level);
+        }
+
+        static void clearCategoryLevels() noexcept {
+            detail::CategoryFilters::clear();
+        }
+
+        /**
+         * @brief Applies a filter list such as "VulkanBackend=Trace, ECS=Warn". "*" names the global
+         * level. Valid entries are applied even if others are malformed.
+         * @return False if any entry could not be parsed.
+         */
+        static bool configureFilters(const std::string_view _spec) {
+            bool valid = true;
+            for (const auto entry: std::views::split(_spec, ',')) {
+                const std::string_view text = trim(std::string_view(entry.begin(), entry.end()));
+                if (text.empty()) continue;
+
+                const auto equals = text.find('=');
+                const auto level = equals == std::string_view::npos
+                                       ? std::nullopt
+                                       : parseLogLevel(trim(text.substr(equals + 1)));
+                if (!level) {
+                    valid = false;
+                    continue;
+                }
+
+                const std::string_view category = trim(text.substr(0, equals));
+                if (category == "*") setLevel(*level);
+                else valid &= setCategoryLevel(category, *level);
+            }
+            return valid;
+        }
+
+        [[nodiscard]] static bool isEnabled(const eLogLevel _level, const uint32_t _categoryId) noexcept {
+            const auto threshold = detail::CategoryFilters::levelFor(_categoryId);
+            return threshold ? _level >= *threshold
+                             : static_cast<int8_t>(_level) >= min_level.load(std::memory_order_relaxed);
+        }
+
         template<typename... Args>
         static void log(eLogLevel _level,
-                        std::string_view _category,
-                        const std::source_location &_loc,
+                        const Context &_ctx,
                         std::format_string<Args...> _fmt,
                         Args &&... _args
         ) {
-            if (static_cast<int8_t>(_level) < min_level.load(std::memory_order_relaxed))
+            if (!isEnabled(_level, _ctx.categoryId))
                 return;
 
-            std::string message = std::format(_fmt, std::forward<Args>(_args)...);
-
-            const auto now = std::chrono::system_clock::now();
-            const auto now_seconds = std::chrono::floor<std::chrono::seconds>(now);
-            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - now_seconds).count();
-
-            std::lock_guard lock(log_mutex);
-            std::string_view colour = levelToColour(_level);
-            std::string_view level = levelToString(_level);
-            std::string paddedLevel = std::format("{:^5}", level);
-            std::string paddedCtx = std::format("{:<1}", _category);
-#ifndef NDEBUG
-            bool shouldShowLoc = false;
-            switch (_level) {
-#define X(name, str, val, showLoc, col) case eLogLevel::name: shouldShowLoc = showLoc; break;
-                LOG_LEVELS
-#undef X
-            }
-
-            if (shouldShowLoc) {
-                std::string_view filename = _loc.file_name();
-                if (const auto pos = filename.find_last_of("/\\"); pos != std::string_view::npos) {
-                    filename = filename.substr(pos + 1);
+            auto &backend = detail::LogBackend::instance();
+            if constexpr (LOG_DEFERRED && (detail::DeferrableArg<Args> && ...)) {
+                if (!pushDeferred<Args...>(backend, _level, _ctx.category, _ctx.location, _fmt.get(), _args...)) {
+                    pushFormatted(backend, _level, _ctx.category, _ctx.location, _fmt, std::forward<Args>(_args)...);
                 }
-
-                std::println( std::cout, "{}[ {:%H:%M:%S}.{:03d} ]{} {}[ {} ]{} {}[{}]:{} {} {}( {}:{} ){}"
-                            , OPN_COL_TIME, now_seconds, ms, OPN_COL_RESET
-                            , colour, paddedLevel, OPN_COL_RESET
-                            , OPN_COL_CTX, paddedCtx, OPN_COL_RESET
-                            , message
-                            , OPN_COL_RESET , filename, _loc.line(), OPN_COL_RESET
-                );
             } else {
-                std::println( std::cout, "{}[ {:%H:%M:%S}.{:03d} ]{} {}[ {} ]{} {}[{}]:{} {}"
-                            , OPN_COL_TIME, now_seconds, ms, OPN_COL_RESET
-                            , colour, paddedLevel, OPN_COL_RESET
-                            , OPN_COL_CTX, paddedCtx, OPN_COL_RESET
-                            , message
-                );
+                pushFormatted(backend, _level, _ctx.category, _ctx.location, _fmt, std::forward<Args>(_args)...);
             }
-#else
-            std::println( std::cout, "{}[ {:%H:%M:%S}.{:03d} ]{} {}[ {} ]{} {}[{}]{}: {}"
-                        , OPN_COL_TIME, now_seconds, ms, OPN_COL_RESET
-                        , colour, paddedLevel, OPN_COL_RESET
-                        , OPN_COL_CTX, paddedCtx, OPN_COL_RESET
-                        , message
-            );
-#endif
+            if (_level == eLogLevel::Critical) backend.flush();
+        }
+
+        /**
+         * @brief Blocks until every line logged so far has been written.
+         */
+        static void flush() {
+            detail::LogBackend::instance().flush();
+        }
+
+        /**
+         * @brief Adds a sink fed from the same record stream as the console, e.g. a RotatingFileSink.
+         * Lines still have to pass the levels above before the sink's own level applies.
+         */
+        static void addSink(std::shared_ptr<iLogSink> _sink) {
+            detail::LogBackend::instance().addSink(std::move(_sink));
+        }
+
+        static void removeSink(const std::shared_ptr<iLogSink> &_sink) {
+            detail::LogBackend::instance().removeSink(_sink);
+        }
+
+        // The sinks installed by default, e.g. to quieten the terminal with consoleSink()->setLevel().
+        [[nodiscard]] static const std::shared_ptr<ConsoleSink> &consoleSink() {
+            return detail::LogBackend::instance().console();
+        }
+
+        [[nodiscard]] static const std::shared_ptr<CrashRingSink> &crashRing() {
+            return detail::LogBackend::instance().crashRing();
+        }
+
+        /**
+         * @brief Call on the way to a fatal abort: writes every pending line, flushes the sinks and
+         * dumps the crash ring to stderr.
+         */
+        static void fatal() {
+            detail::LogBackend::instance().fatal();
         }
 
     private:
-        inline static std::mutex log_mutex;
+        static constexpr std::string_view trim(std::string_view _text) noexcept {
+            while (!_text.empty() && (_text.front() == ' ' || _text.front() == '\t')) _text.remove_prefix(1);
+            while (!_text.empty() && (_text.back() == ' ' || _text.back() == '\t')) _text.remove_suffix(1);
+            return _text;
+        }
+
+        template<typename... Args>
+        static void pushFormatted(detail::LogBackend &_backend, const eLogLevel _level,
+                                  const std::string_view _category, const std::source_location &_loc,
+                                  std::format_string<Args...> _fmt, Args &&... _args) {
+            // Reused per thread so formatting does not allocate once the buffer has grown.
+            thread_local std::string message;
+            message.clear();
+            std::format_to(std::back_inserter(message), _fmt, std::forward<Args>(_args)...);
+            _backend.push(_level, _category, _loc, message);
+        }
+
+        /**
+         * @brief Copies the format string pointer and raw arguments into the ring, no formatting.
+         * @return False if the arguments are too large for one record.
+         */
+        template<typename... Args>
+        static bool pushDeferred(detail::LogBackend &_backend, const eLogLevel _level,
+                                 const std::string_view _category, const std::source_location &_loc,
+                                 const std::string_view _format, const Args &... _args) {
+            const size_t payload = sizeof(detail::sDeferredFormat) + (size_t{0} + ... + detail::deferredArgSize(_args));
+            if (payload > detail::LogBackend::MAX_PAYLOAD) return false;
+
+            // The format string is a constant expression, so it outlives the record.
+            const detail::sDeferredFormat header{&detail::formatDeferred<Args...>, _format.data(), _format.size()};
+            _backend.push(_level, _category, _loc, detail::eRecordKind::Deferred, static_cast<uint32_t>(payload),
+                          [&](std::byte *_out) {
+                              std::memcpy(_out, &header, sizeof(header));
+                              _out += sizeof(header);
+                              ((_out = detail::encodeDeferredArg(_out, _args)), ...);
+                          });
+            return true;
+        }
+
         inline static std::atomic_int8_t min_level = {
 #ifdef NDEBUG
             static_cast<int8_t>(eLogLevel::Info)
@@ -138,41 +235,21 @@ export namespace opn {
             static_cast<int8_t>(eLogLevel::Debug)
 #endif
         };
-
-        static std::string_view levelToColour(const eLogLevel _level) noexcept {
-            switch (_level) {
-#define X(name, str, val, showLoc, col) case eLogLevel::name: return col;
-                LOG_LEVELS
-#undef X
-                default: return OPN_COL_RESET;
-            }
-        }
-
-        static std::string_view levelToString(const eLogLevel _level) noexcept {
-            switch (_level) {
-#define X(name, str, val, showLoc, col) case eLogLevel::name: return str;
-                LOG_LEVELS
-#undef X
-                default: return "UNKNOWN";
-            }
-        }
     };
 }
 
 // MACROS
-#define OPN_GENERATE_LOG_FUNC(name, level)                        \
-    export namespace opn {                                        \
-        template<typename... Args>                                \
-        inline void log##name(Logger::Context _ctx,               \
-                              std::format_string<Args...> _fmt,   \
-                              Args&&... _args) {                  \
-                              Logger::log(                        \
-                                 eLogLevel::level, _ctx.category, \
-                                 _ctx.location,                   \
-                                 _fmt,                            \
-                                 std::forward<Args>(_args)...     \
-                              );                                  \
-        }                                                         \
+#define OPN_GENERATE_LOG_FUNC(name, level)                                \
+    export namespace opn {                                                \
+        template<typename... Args>                                        \
+        inline void log##name(const Logger::Context &_ctx,                \
+                              std::format_string<Args...> _fmt,           \
+                              Args&&... _args) {                          \
+            if constexpr (eLogLevel::level >= LOG_MIN_LEVEL) {            \
+                Logger::log(eLogLevel::level, _ctx, _fmt,                 \
+                            std::forward<Args>(_args)...);                \
+            }                                                             \
+        }                                                                 \
     }
 
 #define X(name, str, val, showLoc, col) OPN_GENERATE_LOG_FUNC(name, name)
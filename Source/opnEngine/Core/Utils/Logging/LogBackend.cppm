@@ -0,0 +1,385 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+export module opn.Utils.Logging:Backend;
+
+import :Record;
+import :Sinks;
+
+export namespace opn::detail {
+    /**
+     * @brief Background writer behind Logger: drains every thread's LogRing and hands the lines,
+     * in timestamp order, to every registered iLogSink one batch per pass.
+     *
+     * Producers only format their message and copy it into their own ring. A full ring makes
+     * Warning and above wait for space while lower levels are dropped and counted, so verbose
+     * logging can never stall a frame. Once shut down, records are written synchronously.
+     */
+    class LogBackend {
+    public:
+        static LogBackend &instance() {
+            // Never destroyed: threads may still log while statics are torn down.
+            static LogBackend *backend = [] {
+                auto *created = new LogBackend();
+                std::atexit([] { instance().shutdown(); });
+                return created;
+            }();
+            return *backend;
+        }
+
+        void push(const eLogLevel _level, const std::string_view _category, const std::source_location &_loc,
+                  std::string_view _message) {
+            _message = _message.substr(0, MAX_PAYLOAD);
+            push(_level, _category, _loc, eRecordKind::Text, static_cast<uint32_t>(_message.size()),
+                 [_message](std::byte *_out) { std::memcpy(_out, _message.data(), _message.size()); });
+        }
+
+        /**
+         * @brief Queues a record whose _payloadLength payload bytes _encodePayload writes in place.
+         * @note _payloadLength must not exceed MAX_PAYLOAD.
+         */
+        template<typename EncodePayload>
+        void push(const eLogLevel _level, std::string_view _category, const std::source_location &_loc,
+                  const eRecordKind _kind, const uint32_t _payloadLength, EncodePayload &&_encodePayload) {
+            _category = _category.substr(0, UINT16_MAX);
+            const uint32_t size = sLogRecord::sizeFor(_category.size(), _payloadLength);
+            if (!m_running.load(std::memory_order_acquire)) {
+                writeSynchronously(_level, _category, _loc, _kind, _payloadLength, _encodePayload);
+                return;
+            }
+
+            LogRing &ring = threadRing();
+            std::byte *slot = ring.reserve(size);
+            while (!slot) {
+                if (_level < eLogLevel::Warning) {
+                    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                    wake();
+                    return;
+                }
+                if (!m_running.load(std::memory_order_acquire)) {
+                    writeSynchronously(_level, _category, _loc, _kind, _payloadLength, _encodePayload);
+                    return;
+                }
+                wake();
+                std::this_thread::yield();
+                slot = ring.reserve(size);
+            }
+
+            encodeHeader(slot, size, _level, _kind, _category, _loc, _payloadLength);
+            _encodePayload(slot + sizeof(sLogRecord) + _category.size());
+            ring.commit();
+
+            // Pairs with the fence in shutdown(): either its final drain sees this record, or we see
+            // the writer is gone and drain it ourselves.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!m_running.load(std::memory_order_relaxed)) {
+                drainAll();
+                return;
+            }
+            if (m_sleeping.load(std::memory_order_relaxed)) wake();
+        }
+
+        /**
+         * @brief Blocks until everything logged before the call has been written.
+         */
+        void flush() {
+            if (!m_running.load(std::memory_order_acquire)) return;
+
+            std::vector<std::pair<std::shared_ptr<LogRing>, uint64_t> > targets;
+            {
+                std::lock_guard lock(m_ringsMutex);
+                for (const auto &ring: m_rings) targets.emplace_back(ring, ring->committed());
+            }
+            for (const auto &[ring, target]: targets) {
+                while (ring->released() < target && m_running.load(std::memory_order_acquire)) {
+                    wake();
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        /**
+         * @brief Stops the writer after it has drained every ring. Later records are written inline.
+         */
+        void shutdown() {
+            if (!m_running.exchange(false, std::memory_order_acq_rel)) return;
+            m_writer.request_stop();
+            wake();
+            m_writer.join();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            drainAll();
+
+            std::lock_guard lock(m_drainMutex);
+            for (const auto &sink: m_sinks) sink->flush();
+        }
+
+        /**
+         * @brief Writes everything pending, then lets each sink react before the process aborts;
+         * the crash ring prints its lines to stderr.
+         */
+        void fatal() {
+            flush();
+            std::lock_guard lock(m_drainMutex);
+            for (const auto &sink: m_sinks) sink->onFatal();
+        }
+
+        void addSink(std::shared_ptr<iLogSink> _sink) {
+            if (!_sink) return;
+            std::lock_guard lock(m_drainMutex);
+            m_sinks.push_back(std::move(_sink));
+        }
+
+        /**
+         * @note Blocks while a batch is being written, so the sink is unused once this returns.
+         */
+        void removeSink(const std::shared_ptr<iLogSink> &_sink) {
+            std::lock_guard lock(m_drainMutex);
+            std::erase(m_sinks, _sink);
+        }
+
+        [[nodiscard]] const std::shared_ptr<ConsoleSink> &console() const noexcept { return m_console; }
+        [[nodiscard]] const std::shared_ptr<CrashRingSink> &crashRing() const noexcept { return m_crashRing; }
+
+        // Larger messages are truncated, larger deferred argument sets are formatted eagerly.
+        static constexpr uint32_t MAX_PAYLOAD = LogRing::CAPACITY / 4;
+
+    private:
+        static constexpr size_t MAX_BATCH = 512;
+        static constexpr std::chrono::milliseconds IDLE_WAIT{5};
+
+        struct sThreadRing {
+            std::shared_ptr<LogRing> ring;
+
+            ~sThreadRing() {
+                if (ring) ring->orphaned.store(true, std::memory_order_release);
+            }
+        };
+
+        std::atomic_bool m_running{true};
+
+        std::mutex m_ringsMutex;
+        std::vector<std::shared_ptr<LogRing> > m_rings;
+        std::atomic_bool m_ringsChanged{false};
+
+        std::mutex m_wakeMutex;
+        std::condition_variable_any m_wakeCondition;
+        std::atomic_bool m_sleeping{false};
+        std::atomic_bool m_signalled{false};
+
+        // Writer state, only touched by whoever drains.
+        std::mutex m_drainMutex;
+        std::vector<std::shared_ptr<LogRing> > m_drainRings;
+        std::vector<const sLogRecord *> m_batch;
+        std::string m_decoded;
+        std::vector<std::pair<size_t, size_t> > m_decodedSpans;
+        std::vector<sLogLine> m_lines;
+        std::vector<std::shared_ptr<iLogSink> > m_sinks;
+        std::shared_ptr<ConsoleSink> m_console = std::make_shared<ConsoleSink>();
+        std::shared_ptr<CrashRingSink> m_crashRing = std::make_shared<CrashRingSink>();
+
+        std::jthread m_writer;
+
+        LogBackend() {
+            m_sinks = {m_console, m_crashRing};
+            m_writer = std::jthread([this](const std::stop_token &_stop) { run(_stop); });
+        }
+
+        LogRing &threadRing() {
+            thread_local sThreadRing local;
+            if (!local.ring) {
+                local.ring = std::make_shared<LogRing>();
+                std::lock_guard lock(m_ringsMutex);
+                m_rings.push_back(local.ring);
+                m_ringsChanged.store(true, std::memory_order_release);
+            }
+            return *local.ring;
+        }
+
+        void wake() {
+            m_signalled.store(true, std::memory_order_release);
+            m_wakeCondition.notify_one();
+        }
+
+        static void encodeHeader(std::byte *_slot, const uint32_t _size, const eLogLevel _level, const eRecordKind _kind,
+                                 const std::string_view _category, const std::source_location &_loc,
+                                 const uint32_t _payloadLength) {
+            const sLogRecord header{
+                .size = _size,
+                .kind = _kind,
+                .level = _level,
+                .categoryLength = static_cast<uint16_t>(_category.size()),
+                .line = _loc.line(),
+                .payloadLength = _payloadLength,
+                .timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count(),
+                .file = _loc.file_name(),
+            };
+            std::memcpy(_slot, &header, sizeof(header));
+            std::memcpy(_slot + sizeof(header), _category.data(), _category.size());
+        }
+
+        void run(const std::stop_token &_stop) {
+            while (!_stop.stop_requested()) {
+                if (drain()) continue;
+
+                std::unique_lock lock(m_wakeMutex);
+                m_sleeping.store(true, std::memory_order_relaxed);
+                m_wakeCondition.wait_for(lock, _stop, IDLE_WAIT, [this] {
+                    return m_signalled.exchange(false, std::memory_order_acq_rel);
+                });
+                m_sleeping.store(false, std::memory_order_relaxed);
+            }
+            drainAll();
+        }
+
+        // A single drain writes at most MAX_BATCH records in total.
+        void drainAll() {
+            while (drain()) {}
+        }
+
+        /**
+         * @brief Writes out up to MAX_BATCH pending records, oldest first across all rings.
+         *
+         * Each ring is already in timestamp order, so the batch is a merge of the ring heads. A busy
+         * thread then cannot fill the batch ahead of older lines from other threads. Only a line
+         * stamped but not yet committed when its batch is cut can still come out late.
+         * @return True if anything was written.
+         */
+        bool drain() {
+            std::lock_guard drainLock(m_drainMutex);
+            if (m_ringsChanged.exchange(false, std::memory_order_acq_rel)) {
+                std::lock_guard lock(m_ringsMutex);
+                std::erase_if(m_rings, [](const auto &_ring) {
+                    return _ring->orphaned.load(std::memory_order_acquire) &&
+                           _ring->released() == _ring->committed();
+                });
+                m_drainRings = m_rings;
+            }
+
+            m_batch.clear();
+            bool orphans = false;
+            uint64_t dropped = 0;
+            for (const auto &ring: m_drainRings) {
+                dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+                orphans |= ring->orphaned.load(std::memory_order_relaxed);
+            }
+
+            while (m_batch.size() < MAX_BATCH) {
+                LogRing *oldest = nullptr;
+                int64_t oldestTime = 0;
+                for (const auto &ring: m_drainRings) {
+                    const sLogRecord *head = ring->peek();
+                    if (head && (!oldest || head->timestampNs < oldestTime)) {
+                        oldest = ring.get();
+                        oldestTime = head->timestampNs;
+                    }
+                }
+                if (!oldest) break;
+                m_batch.push_back(oldest->next());
+            }
+            if (orphans) m_ringsChanged.store(true, std::memory_order_relaxed);
+            if (dropped != 0) reportDropped(dropped);
+            if (m_batch.empty()) return false;
+
+            writeBatch(m_batch);
+
+            for (const auto &ring: m_drainRings) ring->release();
+            return true;
+        }
+
+        void reportDropped(const uint64_t _count) {
+            const std::string message = std::format("{} log records dropped, ring full.", _count);
+            writeRecord(eLogLevel::Warning, "Logger", std::source_location::current(), eRecordKind::Text,
+                        static_cast<uint32_t>(message.size()),
+                        [&](std::byte *_out) { std::memcpy(_out, message.data(), message.size()); });
+        }
+
+        template<typename EncodePayload>
+        void writeSynchronously(const eLogLevel _level, const std::string_view _category,
+                                const std::source_location &_loc, const eRecordKind _kind,
+                                const uint32_t _payloadLength, EncodePayload &_encodePayload) {
+            std::lock_guard lock(m_drainMutex);
+            writeRecord(_level, _category, _loc, _kind, _payloadLength, _encodePayload);
+        }
+
+        /**
+         * @brief Encodes and writes a single record outside any ring. Caller holds m_drainMutex.
+         */
+        template<typename EncodePayload>
+        void writeRecord(const eLogLevel _level, const std::string_view _category, const std::source_location &_loc,
+                         const eRecordKind _kind, const uint32_t _payloadLength, EncodePayload &&_encodePayload) {
+            const uint32_t size = sLogRecord::sizeFor(_category.size(), _payloadLength);
+
+            // uint64_t storage keeps the header aligned.
+            std::vector<uint64_t> buffer((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+            auto *bytes = reinterpret_cast<std::byte *>(buffer.data());
+            encodeHeader(bytes, size, _level, _kind, _category, _loc, _payloadLength);
+            _encodePayload(bytes + sizeof(sLogRecord) + _category.size());
+            const auto *record = reinterpret_cast<const sLogRecord *>(bytes);
+            writeBatch(std::span(&record, 1));
+        }
+
+        /**
+         * @brief Decodes the batch once and hands the same lines to every sink. Text messages stay
+         * where they live, deferred ones are formatted into m_decoded first.
+         */
+        void writeBatch(const std::span<const sLogRecord *const> _records) {
+            m_decoded.clear();
+            m_decodedSpans.clear();
+            for (const sLogRecord *record: _records) {
+                const size_t start = m_decoded.size();
+                if (record->kind == eRecordKind::Deferred) formatDeferredRecord(*record);
+                m_decodedSpans.emplace_back(start, m_decoded.size() - start);
+            }
+
+            // m_decoded is complete, so views into it stay valid from here on.
+            m_lines.clear();
+            for (size_t i = 0; i < _records.size(); ++i) {
+                const auto [start, length] = m_decodedSpans[i];
+                m_lines.push_back({
+                    _records[i],
+                    _records[i]->kind == eRecordKind::Deferred
+                        ? std::string_view(m_decoded).substr(start, length)
+                        : _records[i]->message()
+                });
+            }
+
+            for (const auto &sink: m_sinks) {
+                // One failing sink must not take the writer thread, and the other sinks, with it.
+                try {
+                    sink->write(m_lines);
+                } catch (const std::exception &) {}
+            }
+        }
+
+        void formatDeferredRecord(const sLogRecord &_record) {
+            sDeferredFormat deferred{};
+            std::memcpy(&deferred, _record.payload(), sizeof(deferred));
+            try {
+                deferred.format(m_decoded, std::string_view(deferred.formatString, deferred.formatLength),
+                                _record.payload() + sizeof(deferred));
+            } catch (const std::exception &e) {
+                m_decoded.append("<log format error: ").append(e.what()).append(">");
+            }
+        }
+    };
+}
@@ -0,0 +1,105 @@
+module;
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+export module opn.Utils.Logging:Deferred;
+
+import :Record;
+
+export namespace opn {
+    /**
+     * @brief Opt-in for deferred formatting of other trivially copyable types. Specialize with
+     * enabled = true only for types that own all their data: no pointers, references or handles
+     * to memory that may be gone by the time the writer thread formats the record.
+     */
+    template<typename T>
+    struct DeferredLogTraits {
+        static constexpr bool enabled = false;
+    };
+}
+
+export namespace opn::detail {
+    template<typename T>
+    concept DeferredStringArg = std::convertible_to<const T &, std::string_view> && !std::same_as<T, std::nullptr_t>;
+
+    /**
+     * @brief Arguments whose bytes can be copied now and formatted later: arithmetic values, enums and
+     * untyped pointers, which format as addresses, plus types enabled through DeferredLogTraits.
+     * Anything else is formatted on the calling thread.
+     */
+    template<typename T>
+    concept DeferredValueArg = std::is_arithmetic_v<T> || std::is_enum_v<T> || std::same_as<T, std::nullptr_t> ||
+                               std::same_as<std::remove_cv_t<std::remove_pointer_t<T> >, void> ||
+                               (DeferredLogTraits<T>::enabled && std::is_trivially_copyable_v<T>);
+
+    template<typename T>
+    concept DeferrableArg = DeferredStringArg<std::remove_cvref_t<T> > || DeferredValueArg<std::remove_cvref_t<T> >;
+
+    template<typename T>
+    using tDeferredDecoded = std::conditional_t<DeferredStringArg<std::remove_cvref_t<T> >, std::string_view,
+                                                std::remove_cvref_t<T> >;
+
+    template<typename T>
+    size_t deferredArgSize(const T &_arg) noexcept {
+        if constexpr (DeferredStringArg<std::remove_cvref_t<T> >) {
+            return sizeof(uint32_t) + std::string_view(_arg).size();
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    template<typename T>
+    std::byte *encodeDeferredArg(std::byte *_out, const T &_arg) noexcept {
+        if constexpr (DeferredStringArg<std::remove_cvref_t<T> >) {
+            const std::string_view text(_arg);
+            const auto length = static_cast<uint32_t>(text.size());
+            std::memcpy(_out, &length, sizeof(length));
+            std::memcpy(_out + sizeof(length), text.data(), text.size());
+            return _out + sizeof(length) + text.size();
+        } else {
+            std::memcpy(_out, &_arg, sizeof(T));
+            return _out + sizeof(T);
+        }
+    }
+
+    template<typename T>
+    tDeferredDecoded<T> decodeDeferredArg(const std::byte *&_cursor) noexcept {
+        if constexpr (DeferredStringArg<std::remove_cvref_t<T> >) {
+            uint32_t length = 0;
+            std::memcpy(&length, _cursor, sizeof(length));
+            const std::string_view text(reinterpret_cast<const char *>(_cursor + sizeof(length)), length);
+            _cursor += sizeof(length) + length;
+            return text;
+        } else {
+            std::array<std::byte, sizeof(T)> raw;
+            std::memcpy(raw.data(), _cursor, sizeof(T));
+            _cursor += sizeof(T);
+            return std::bit_cast<std::remove_cvref_t<T> >(raw);
+        }
+    }
+
+    /**
+     * @brief Rebuilds the arguments encoded by encodeDeferredArg and formats them into _out. Runs
+     * on the log writer thread.
+     */
+    template<typename... Args>
+    void formatDeferred(std::string &_out, const std::string_view _format, const std::byte *_args) {
+        const std::byte *cursor = _args;
+        // Braced initialisation decodes left to right, matching the encode order.
+        std::tuple<tDeferredDecoded<Args>...> values{decodeDeferredArg<Args>(cursor)...};
+        std::apply([&](auto &... _values) {
+            std::vformat_to(std::back_inserter(_out), _format, std::make_format_args(_values...));
+        }, values);
+    }
+}
@@ -0,0 +1,104 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+#include "LogLevels.h"
+
+export module opn.Utils.Logging:Filter;
+
+import :Record;
+
+export namespace opn {
+    /**
+     * @brief FNV-1a hash of a log category, computed at compile time for literal categories.
+     */
+    constexpr uint32_t logCategoryId(const std::string_view _category) noexcept {
+        uint32_t hash = 2166136261u;
+        for (const char c: _category) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Parses a level by name, case-insensitively, e.g. "Warning" or its short form "WARN".
+     */
+    constexpr std::optional<eLogLevel> parseLogLevel(const std::string_view _text) noexcept {
+        const auto equals = [&](const std::string_view _name) {
+            return std::ranges::equal(_text, _name, [](const char _a, const char _b) {
+                const auto lower = [](const char _c) { return _c >= 'A' && _c <= 'Z' ? static_cast<char>(_c + 32) : _c; };
+                return lower(_a) == lower(_b);
+            });
+        };
+#define X(name, str, val, showLoc, col) if (equals(#name) || equals(str)) return eLogLevel::name;
+        LOG_LEVELS
+#undef X
+        return std::nullopt;
+    }
+}
+
+export namespace opn::detail {
+    /**
+     * @brief Per-category level overrides keyed by logCategoryId().
+     *
+     * Lookups are lock-free probes of a small open-addressed table and skip it entirely while no
+     * override is set; changes take a mutex and are expected to be rare.
+     */
+    class CategoryFilters {
+    public:
+        static constexpr size_t CAPACITY = 64;
+
+        static std::optional<eLogLevel> levelFor(const uint32_t _id) noexcept {
+            if (s_count.load(std::memory_order_relaxed) == 0) return std::nullopt;
+
+            for (size_t probe = 0; probe < CAPACITY; ++probe) {
+                const uint64_t slot = s_slots[(_id + probe) & (CAPACITY - 1)].load(std::memory_order_relaxed);
+                if (slot == 0) return std::nullopt;
+                if (static_cast<uint32_t>(slot >> 32) == _id) return static_cast<eLogLevel>(slot & 0xFF);
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @return False once the table is full.
+         */
+        static bool set(const uint32_t _id, const eLogLevel _level) noexcept {
+            std::lock_guard lock(s_mutex);
+            // The used bit keeps a stored entry non-zero whatever the id and level.
+            const uint64_t entry = static_cast<uint64_t>(_id) << 32 | USED_BIT | static_cast<uint8_t>(_level);
+
+            for (size_t probe = 0; probe < CAPACITY; ++probe) {
+                auto &slot = s_slots[(_id + probe) & (CAPACITY - 1)];
+                const uint64_t current = slot.load(std::memory_order_relaxed);
+                if (current != 0 && static_cast<uint32_t>(current >> 32) != _id) continue;
+
+                slot.store(entry, std::memory_order_relaxed);
+                if (current == 0) s_count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        static void clear() noexcept {
+            std::lock_guard lock(s_mutex);
+            for (auto &slot: s_slots) slot.store(0, std::memory_order_relaxed);
+            s_count.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr uint64_t USED_BIT = 1u << 8;
+
+        inline static std::array<std::atomic<uint64_t>, CAPACITY> s_slots{};
+        inline static std::atomic<uint32_t> s_count{0};
+        inline static std::mutex s_mutex;
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Shared by the opn.Utils.Logging units, macros do not cross module boundaries.
+
+#define OPN_COL_RESET       "\x1b[0m"
+#define OPN_COL_TIME        "\x1b[38;5;250m"
+#define OPN_COL_CTX         "\x1b[34m"
+#define OPN_COL_BRACKET     "\x1b[37m"
+
+#define OPN_COL_PINK        "\x1b[95m"
+#define OPN_COL_CYAN        "\x1b[36m"
+#define OPN_COL_WHITE       "\x1b[37m"
+#define OPN_COL_YELLOW      "\x1b[33m"
+#define OPN_COL_ORANGE      "\x1b[38;5;208m"
+#define OPN_COL_BOLD_RED    "\x1b[1;31m"
+
+// Defines all forms of logging code will automatically
+// generate new levels if added to this X macro list.
+#define LOG_LEVELS                                   \
+    X(Trace,    "TRACE", 0, false, OPN_COL_PINK)     \
+    X(Debug,    "DEBUG", 1, false, OPN_COL_CYAN)     \
+    X(Info,     "INFO",  2, false, OPN_COL_WHITE)    \
+    X(Warning,  "WARN",  3, true,  OPN_COL_YELLOW)   \
+    X(Error,    "ERROR", 4, true,  OPN_COL_ORANGE)   \
+    X(Critical, "CRIT",  5, true,  OPN_COL_BOLD_RED)
@@ -0,0 +1,207 @@
+module;
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "LogLevels.h"
+
+export module opn.Utils.Logging:Record;
+
+export namespace opn {
+    enum class eLogLevel : int8_t {
+#define X(name, str, val, showLoc, col) name = val,
+        LOG_LEVELS
+#undef X
+    };
+
+    namespace detail {
+        constexpr std::string_view levelToColour(const eLogLevel _level) noexcept {
+            switch (_level) {
+#define X(name, str, val, showLoc, col) case eLogLevel::name: return col;
+                LOG_LEVELS
+#undef X
+                default: return OPN_COL_RESET;
+            }
+        }
+
+        constexpr std::string_view levelToString(const eLogLevel _level) noexcept {
+            switch (_level) {
+#define X(name, str, val, showLoc, col) case eLogLevel::name: return str;
+                LOG_LEVELS
+#undef X
+                default: return "UNKNOWN";
+            }
+        }
+
+        constexpr bool levelShowsLocation(const eLogLevel _level) noexcept {
+            switch (_level) {
+#define X(name, str, val, showLoc, col) case eLogLevel::name: return showLoc;
+                LOG_LEVELS
+#undef X
+                default: return false;
+            }
+        }
+
+        enum class eRecordKind : uint8_t {
+            Padding,
+            // Payload is the formatted message.
+            Text,
+            // Payload is an sDeferredFormat followed by the raw arguments, formatted by the writer.
+            Deferred
+        };
+
+        // Leading bytes of every ring entry, padding included.
+        struct sRecordPrefix {
+            uint32_t size;
+            eRecordKind kind;
+        };
+
+        /**
+         * @brief One log line as it sits in a LogRing: this header, then the category and payload bytes.
+         * @note file points at source_location storage, which lives as long as the program.
+         */
+        struct sLogRecord {
+            uint32_t size;
+            eRecordKind kind;
+            eLogLevel level;
+            uint16_t categoryLength;
+            uint32_t line;
+            uint32_t payloadLength;
+            int64_t timestampNs;
+            const char *file;
+
+            static constexpr uint32_t ALIGN = 8;
+
+            static constexpr uint32_t sizeFor(const size_t _category, const size_t _payload) noexcept {
+                const auto raw = static_cast<uint32_t>(sizeof(sLogRecord) + _category + _payload);
+                return (raw + ALIGN - 1) & ~(ALIGN - 1);
+            }
+
+            [[nodiscard]] std::string_view category() const noexcept {
+                return {reinterpret_cast<const char *>(this + 1), categoryLength};
+            }
+
+            [[nodiscard]] const std::byte *payload() const noexcept {
+                return reinterpret_cast<const std::byte *>(this + 1) + categoryLength;
+            }
+
+            /**
+             * @note Text records only, Deferred ones hold arguments instead.
+             */
+            [[nodiscard]] std::string_view message() const noexcept {
+                return {reinterpret_cast<const char *>(payload()), payloadLength};
+            }
+        };
+
+        using tDeferredFormatFn = void (*)(std::string &_out, std::string_view _format, const std::byte *_args);
+
+        // Leads a Deferred payload. Copied with memcpy, the payload is not aligned for it.
+        struct sDeferredFormat {
+            tDeferredFormatFn format;
+            const char *formatString;
+            size_t formatLength;
+        };
+
+        static_assert(sizeof(sLogRecord) % sLogRecord::ALIGN == 0);
+
+        /**
+         * @brief Single-producer single-consumer byte ring of log records, one per logging thread.
+         *
+         * The owning thread reserves a contiguous block, fills it and commits; a block that would
+         * straddle the end is preceded by a padding entry. The writer thread walks entries with
+         * next() and hands the space back with release() once they are written, so messages can be
+         * written straight out of the ring.
+         */
+        class LogRing {
+        public:
+            static constexpr uint32_t CAPACITY = 1u << 18;
+            static constexpr uint32_t MASK = CAPACITY - 1;
+
+            LogRing() : m_buffer(std::make_unique<std::byte[]>(CAPACITY)) {}
+
+            // -- Producer --
+
+            /**
+             * @return Space for _size bytes, nullptr while the ring is too full.
+             */
+            std::byte *reserve(const uint32_t _size) noexcept {
+                const uint64_t head = m_head.load(std::memory_order_relaxed);
+                const uint32_t offset = static_cast<uint32_t>(head) & MASK;
+                const uint32_t pad = offset + _size > CAPACITY ? CAPACITY - offset : 0;
+
+                if (head + pad + _size - m_cachedTail > CAPACITY) {
+                    m_cachedTail = m_tail.load(std::memory_order_acquire);
+                    if (head + pad + _size - m_cachedTail > CAPACITY) return nullptr;
+                }
+
+                if (pad != 0) {
+                    const sRecordPrefix padding{pad, eRecordKind::Padding};
+                    std::memcpy(m_buffer.get() + offset, &padding, sizeof(padding));
+                }
+                m_reserved = pad + _size;
+                return m_buffer.get() + ((head + pad) & MASK);
+            }
+
+            void commit() noexcept {
+                m_head.store(m_head.load(std::memory_order_relaxed) + m_reserved, std::memory_order_release);
+            }
+
+            // -- Consumer --
+
+            /**
+             * @return The next unread record without consuming it, nullptr when caught up.
+             */
+            const sLogRecord *peek() noexcept {
+                while (true) {
+                    if (m_readCursor == m_cachedHead) {
+                        m_cachedHead = m_head.load(std::memory_order_acquire);
+                        if (m_readCursor == m_cachedHead) return nullptr;
+                    }
+
+                    const std::byte *at = m_buffer.get() + (static_cast<uint32_t>(m_readCursor) & MASK);
+                    sRecordPrefix prefix{};
+                    std::memcpy(&prefix, at, sizeof(prefix));
+                    if (prefix.kind != eRecordKind::Padding) return reinterpret_cast<const sLogRecord *>(at);
+                    m_readCursor += prefix.size;
+                }
+            }
+
+            /**
+             * @return The next unread record, nullptr when caught up. Stays valid until release().
+             */
+            const sLogRecord *next() noexcept {
+                const sLogRecord *record = peek();
+                if (record) m_readCursor += record->size;
+                return record;
+            }
+
+            void release() noexcept {
+                m_tail.store(m_readCursor, std::memory_order_release);
+            }
+
+            [[nodiscard]] uint64_t committed() const noexcept { return m_head.load(std::memory_order_acquire); }
+            [[nodiscard]] uint64_t released() const noexcept { return m_tail.load(std::memory_order_acquire); }
+
+            // Records given up on a full ring, reported by the writer.
+            std::atomic<uint64_t> dropped{0};
+            // Set once the owning thread has exited; the writer drops the ring when it is drained.
+            std::atomic_bool orphaned{false};
+
+        private:
+            std::unique_ptr<std::byte[]> m_buffer;
+
+            alignas(64) std::atomic<uint64_t> m_head{0};
+            uint64_t m_cachedTail = 0;
+            uint32_t m_reserved = 0;
+
+            alignas(64) std::atomic<uint64_t> m_tail{0};
+            uint64_t m_cachedHead = 0;
+            uint64_t m_readCursor = 0;
+        };
+    }
+}
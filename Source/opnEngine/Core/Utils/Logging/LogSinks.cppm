@@ -0,0 +1,444 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "LogLevels.h"
+
+export module opn.Utils.Logging:Sinks;
+
+import :Record;
+
+export namespace opn {
+    /**
+     * @brief One decoded line handed to the sinks. message points into the writer's batch and is
+     * only valid during iLogSink::write().
+     */
+    struct sLogLine {
+        const detail::sLogRecord *record;
+        std::string_view message;
+    };
+
+    /**
+     * @brief Destination for log lines. Every sink sees the same record stream, in timestamp order,
+     * and skips lines below its own level.
+     *
+     * write() runs on the log writer thread; a sink must not log from it.
+     */
+    class iLogSink {
+    public:
+        virtual ~iLogSink() = default;
+
+        virtual void write(std::span<const sLogLine> _lines) = 0;
+
+        virtual void flush() {}
+
+        /**
+         * @brief Called once everything pending has been written and the process is about to abort.
+         */
+        virtual void onFatal() { flush(); }
+
+        void setLevel(const eLogLevel _level) noexcept { m_level.store(_level, std::memory_order_relaxed); }
+
+        [[nodiscard]] eLogLevel getLevel() const noexcept { return m_level.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] bool accepts(const eLogLevel _level) const noexcept { return _level >= getLevel(); }
+
+    private:
+        std::atomic<eLogLevel> m_level{eLogLevel::Trace};
+    };
+}
+
+namespace opn::detail {
+    std::string_view fileName(const std::string_view _path) noexcept {
+        if (const auto pos = _path.find_last_of("/\\"); pos != std::string_view::npos) return _path.substr(pos + 1);
+        return _path;
+    }
+
+    std::chrono::sys_time<std::chrono::nanoseconds> recordTime(const int64_t _timestampNs) noexcept {
+        return std::chrono::sys_time<std::chrono::nanoseconds>(std::chrono::nanoseconds(_timestampNs));
+    }
+
+    /**
+     * @brief Uncoloured single line shared by the file sink and the crash ring, with the date so
+     * files spanning midnight stay readable.
+     */
+    void appendPlainLine(std::string &_out, const sLogRecord &_header, const std::string_view _category,
+                         const std::string_view _message) {
+        const auto time = std::chrono::floor<std::chrono::milliseconds>(recordTime(_header.timestampNs));
+        std::format_to(std::back_inserter(_out), "{:%F %T} [ {:^5} ] [{}]: {}",
+                       time, levelToString(_header.level), _category, _message);
+        if (levelShowsLocation(_header.level)) {
+            std::format_to(std::back_inserter(_out), " ( {}:{} )", fileName(_header.file), _header.line);
+        }
+        _out.push_back('\n');
+    }
+
+    void appendJsonString(std::string &_out, const std::string_view _text) {
+        _out.push_back('"');
+        for (const char c: _text) {
+            switch (c) {
+                case '"': _out.append("\\\"");
+                    break;
+                case '\\': _out.append("\\\\");
+                    break;
+                case '\n': _out.append("\\n");
+                    break;
+                case '\r': _out.append("\\r");
+                    break;
+                case '\t': _out.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        std::format_to(std::back_inserter(_out), "\\u{:04x}", static_cast<unsigned>(c));
+                    } else {
+                        _out.push_back(c);
+                    }
+            }
+        }
+        _out.push_back('"');
+    }
+
+    /**
+     * @brief Append-only file that rolls over to path.1 … path.N once it would pass a size limit.
+     *
+     * Opened in append mode, so the OS places every write at the end even if another process
+     * shares the file. Callers hand it a whole batch at a time, which stdio turns into one write.
+     */
+    class LogFile {
+    public:
+        LogFile(std::filesystem::path _path, const uint64_t _maxBytes, const uint32_t _maxFiles)
+            : m_path(std::move(_path)), m_maxBytes(_maxBytes), m_maxFiles(_maxFiles) {
+            std::error_code error;
+            if (m_path.has_parent_path()) std::filesystem::create_directories(m_path.parent_path(), error);
+            open();
+        }
+
+        ~LogFile() {
+            if (m_file) std::fclose(m_file);
+        }
+
+        LogFile(const LogFile &) = delete;
+        LogFile &operator=(const LogFile &) = delete;
+
+        [[nodiscard]] bool isOpen() const noexcept { return m_file != nullptr; }
+
+        void append(const std::string_view _bytes) {
+            if (_bytes.empty()) return;
+            if (m_size != 0 && m_size + _bytes.size() > m_maxBytes) rotate();
+            if (!m_file) return;
+
+            m_size += std::fwrite(_bytes.data(), 1, _bytes.size(), m_file);
+            std::fflush(m_file);
+        }
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+        std::filesystem::path m_path;
+        uint64_t m_maxBytes;
+        uint32_t m_maxFiles;
+        std::FILE *m_file = nullptr;
+        uint64_t m_size = 0;
+
+        void open() {
+            m_file = std::fopen(m_path.string().c_str(), "ab");
+            if (!m_file) return;
+            std::setvbuf(m_file, nullptr, _IOFBF, BUFFER_SIZE);
+
+            std::error_code error;
+            const auto existing = std::filesystem::file_size(m_path, error);
+            m_size = error ? 0 : existing;
+        }
+
+        [[nodiscard]] std::filesystem::path backupPath(const uint32_t _index) const {
+            return std::filesystem::path(m_path).concat(std::format(".{}", _index));
+        }
+
+        void rotate() {
+            if (m_file) std::fclose(m_file);
+            m_file = nullptr;
+
+            // Failures leave the current file in place; it keeps growing rather than losing lines.
+            std::error_code error;
+            if (m_maxFiles == 0) {
+                std::filesystem::remove(m_path, error);
+            } else {
+                std::filesystem::remove(backupPath(m_maxFiles), error);
+                for (uint32_t i = m_maxFiles - 1; i >= 1; --i) {
+                    std::filesystem::rename(backupPath(i), backupPath(i + 1), error);
+                }
+                std::filesystem::rename(m_path, backupPath(1), error);
+            }
+            open();
+        }
+    };
+}
+
+export namespace opn {
+    /**
+     * @brief The coloured terminal output, written with one writev per batch. Installed by default.
+     */
+    class ConsoleSink final : public iLogSink {
+    public:
+        void write(const std::span<const sLogLine> _lines) override {
+            m_text.clear();
+            m_layout.clear();
+            for (const sLogLine &line: _lines) {
+                if (!accepts(line.record->level)) continue;
+
+                sLineLayout layout{.prefixStart = m_text.size()};
+                formatPrefix(*line.record);
+                layout.suffixStart = m_text.size();
+                formatSuffix(*line.record);
+                layout.message = line.message;
+                m_layout.push_back(layout);
+            }
+
+            // m_text is complete, so pointers into it stay valid from here on.
+            m_slices.clear();
+            for (size_t i = 0; i < m_layout.size(); ++i) {
+                const sLineLayout &layout = m_layout[i];
+                const size_t suffixEnd = i + 1 < m_layout.size() ? m_layout[i + 1].prefixStart : m_text.size();
+                m_slices.push_back({m_text.data() + layout.prefixStart, layout.suffixStart - layout.prefixStart});
+                m_slices.push_back({layout.message.data(), layout.message.size()});
+                m_slices.push_back({m_text.data() + layout.suffixStart, suffixEnd - layout.suffixStart});
+            }
+            writeConsole(m_slices);
+        }
+
+    private:
+        // Where one line's decoration sits in m_text.
+        struct sLineLayout {
+            size_t prefixStart = 0;
+            size_t suffixStart = 0;
+            std::string_view message{};
+        };
+
+        struct sSlice {
+            const char *data;
+            size_t size;
+        };
+
+        std::string m_text;
+        std::vector<sLineLayout> m_layout;
+        std::vector<sSlice> m_slices;
+
+        void formatPrefix(const detail::sLogRecord &_record) {
+            const auto now = detail::recordTime(_record.timestampNs);
+            const auto nowSeconds = std::chrono::floor<std::chrono::seconds>(now);
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - nowSeconds).count();
+
+#ifndef NDEBUG
+            std::format_to(std::back_inserter(m_text), "{}[ {:%H:%M:%S}.{:03d} ]{} {}[ {:^5} ]{} {}[{}]:{} "
+                           , OPN_COL_TIME, nowSeconds, ms, OPN_COL_RESET
+                           , detail::levelToColour(_record.level), detail::levelToString(_record.level), OPN_COL_RESET
+                           , OPN_COL_CTX, _record.category(), OPN_COL_RESET
+            );
+#else
+            std::format_to(std::back_inserter(m_text), "{}[ {:%H:%M:%S}.{:03d} ]{} {}[ {:^5} ]{} {}[{}]{}: "
+                           , OPN_COL_TIME, nowSeconds, ms, OPN_COL_RESET
+                           , detail::levelToColour(_record.level), detail::levelToString(_record.level), OPN_COL_RESET
+                           , OPN_COL_CTX, _record.category(), OPN_COL_RESET
+            );
+#endif
+        }
+
+        void formatSuffix(const detail::sLogRecord &_record) {
+#ifndef NDEBUG
+            if (detail::levelShowsLocation(_record.level)) {
+                std::format_to(std::back_inserter(m_text), " {}( {}:{} ){}"
+                               , OPN_COL_RESET, detail::fileName(_record.file), _record.line, OPN_COL_RESET
+                );
+            }
+#endif
+            m_text.push_back('\n');
+        }
+
+        static void writeConsole(const std::span<const sSlice> _slices) {
+#ifdef _WIN32
+            for (const auto &slice: _slices) std::fwrite(slice.data, 1, slice.size, stdout);
+            std::fflush(stdout);
+#else
+            constexpr size_t IOV_BATCH = 1023;
+            iovec iov[IOV_BATCH];
+
+            for (size_t first = 0; first < _slices.size(); first += IOV_BATCH) {
+                const size_t count = std::min(IOV_BATCH, _slices.size() - first);
+                for (size_t i = 0; i < count; ++i) {
+                    iov[i] = {const_cast<char *>(_slices[first + i].data), _slices[first + i].size};
+                }
+
+                iovec *pending = iov;
+                int left = static_cast<int>(count);
+                while (left > 0) {
+                    ssize_t written = ::writev(STDOUT_FILENO, pending, left);
+                    if (written < 0) {
+                        if (errno == EINTR) continue;
+                        return;
+                    }
+                    // Skip what went out, resuming mid-slice after a short write.
+                    while (left > 0 && static_cast<size_t>(written) >= pending->iov_len) {
+                        written -= static_cast<ssize_t>(pending->iov_len);
+                        ++pending;
+                        --left;
+                    }
+                    if (left > 0) {
+                        pending->iov_base = static_cast<char *>(pending->iov_base) + written;
+                        pending->iov_len -= static_cast<size_t>(written);
+                    }
+                }
+            }
+#endif
+        }
+    };
+
+    /**
+     * @brief Plain text log file, rotated by size into path.1 … path.maxFiles.
+     */
+    class RotatingFileSink final : public iLogSink {
+    public:
+        explicit RotatingFileSink(std::filesystem::path _path, const uint64_t _maxBytes = 16ull * 1024 * 1024,
+                                  const uint32_t _maxFiles = 5)
+            : m_file(std::move(_path), _maxBytes, _maxFiles) {}
+
+        [[nodiscard]] bool isOpen() const noexcept { return m_file.isOpen(); }
+
+        void write(const std::span<const sLogLine> _lines) override {
+            m_buffer.clear();
+            for (const sLogLine &line: _lines) {
+                if (!accepts(line.record->level)) continue;
+                detail::appendPlainLine(m_buffer, *line.record, line.record->category(), line.message);
+            }
+            m_file.append(m_buffer);
+        }
+
+    private:
+        detail::LogFile m_file;
+        std::string m_buffer;
+    };
+
+    /**
+     * @brief One JSON object per line for log ingestion, e.g.
+     * {"ts":"2025-01-01T12:00:00.000Z","tsNs":…,"level":"WARN","category":"ECS","message":"…","file":"…","line":42}
+     */
+    class JsonLinesSink final : public iLogSink {
+    public:
+        explicit JsonLinesSink(std::filesystem::path _path, const uint64_t _maxBytes = 64ull * 1024 * 1024,
+                               const uint32_t _maxFiles = 5)
+            : m_file(std::move(_path), _maxBytes, _maxFiles) {}
+
+        [[nodiscard]] bool isOpen() const noexcept { return m_file.isOpen(); }
+
+        void write(const std::span<const sLogLine> _lines) override {
+            m_buffer.clear();
+            for (const sLogLine &line: _lines) {
+                if (!accepts(line.record->level)) continue;
+
+                const detail::sLogRecord &record = *line.record;
+                const auto time = std::chrono::floor<std::chrono::milliseconds>(detail::recordTime(record.timestampNs));
+                std::format_to(std::back_inserter(m_buffer), R"({{"ts":"{:%FT%T}Z","tsNs":{},"level":)",
+                               time, record.timestampNs);
+                detail::appendJsonString(m_buffer, detail::levelToString(record.level));
+                m_buffer.append(R"(,"category":)");
+                detail::appendJsonString(m_buffer, record.category());
+                m_buffer.append(R"(,"message":)");
+                detail::appendJsonString(m_buffer, line.message);
+                m_buffer.append(R"(,"file":)");
+                detail::appendJsonString(m_buffer, detail::fileName(record.file));
+                std::format_to(std::back_inserter(m_buffer), R"(,"line":{}}})", record.line);
+                m_buffer.push_back('\n');
+            }
+            m_file.append(m_buffer);
+        }
+
+    private:
+        detail::LogFile m_file;
+        std::string m_buffer;
+    };
+
+    /**
+     * @brief Keeps the last lines in memory and prints them to stderr when the process dies on a
+     * fatal error. Installed by default.
+     *
+     * Lines are copied into fixed slots, truncated to TEXT_CAPACITY bytes of category and message,
+     * so recording never allocates and nothing is formatted until a dump.
+     */
+    class CrashRingSink final : public iLogSink {
+    public:
+        static constexpr size_t TEXT_CAPACITY = 256;
+
+        explicit CrashRingSink(const size_t _capacity = 256) : m_slots(std::max<size_t>(_capacity, 1)) {}
+
+        void write(const std::span<const sLogLine> _lines) override {
+            std::lock_guard lock(m_mutex);
+            for (const sLogLine &line: _lines) {
+                if (!accepts(line.record->level)) continue;
+
+                sSlot &slot = m_slots[m_next % m_slots.size()];
+                slot.header = *line.record;
+                const std::string_view category = line.record->category().substr(0, TEXT_CAPACITY);
+                const std::string_view message = line.message.substr(0, TEXT_CAPACITY - category.size());
+                std::ranges::copy(category, slot.text.begin());
+                std::ranges::copy(message, slot.text.begin() + category.size());
+                slot.categoryLength = static_cast<uint16_t>(category.size());
+                slot.messageLength = static_cast<uint16_t>(message.size());
+                ++m_next;
+            }
+        }
+
+        void onFatal() override { dump(stderr); }
+
+        /**
+         * @brief Writes the remembered lines, oldest first.
+         */
+        void dump(std::FILE *_out) {
+            std::lock_guard lock(m_mutex);
+            const size_t count = std::min<uint64_t>(m_next, m_slots.size());
+
+            std::string text = std::format("---- last {} log lines ----\n", count);
+            for (uint64_t i = m_next - count; i < m_next; ++i) {
+                const sSlot &slot = m_slots[i % m_slots.size()];
+                const std::string_view stored(slot.text.data(), slot.categoryLength + slot.messageLength);
+                detail::appendPlainLine(text, slot.header, stored.substr(0, slot.categoryLength),
+                                        stored.substr(slot.categoryLength));
+            }
+            text.append("---- end of log ----\n");
+            std::fwrite(text.data(), 1, text.size(), _out);
+            std::fflush(_out);
+        }
+
+    private:
+        struct sSlot {
+            // Copy of the record header; its category() and message() do not apply here.
+            detail::sLogRecord header{};
+            uint16_t categoryLength = 0;
+            uint16_t messageLength = 0;
+            std::array<char, TEXT_CAPACITY> text{};
+        };
+
+        std::mutex m_mutex;
+        std::vector<sSlot> m_slots;
+        uint64_t m_next = 0;
+    };
+}